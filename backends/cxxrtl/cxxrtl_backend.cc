@@ -715,6 +715,8 @@ bool is_valid_clock(const RTLIL::SigSpec& sig) {
 struct CxxrtlWorker {
 	bool split_intf = false;
 	std::string intf_filename;
+	std::string split_dir, split_include;
+	int split_size = 0;
 	std::string design_ns = "cxxrtl_design";
 	std::string print_output = "std::cout";
 	std::ostream *impl_f = nullptr;
@@ -2840,7 +2842,9 @@ struct CxxrtlWorker {
 			*intf_f << f.str(); f.str("");
 		}
 
-		if (split_intf)
+		if (!split_dir.empty())
+			f << "#include \"" << split_include << "\"\n";
+		else if (split_intf)
 			f << "#include \"" << basename(intf_filename) << "\"\n";
 		else
 			f << "#include <cxxrtl/cxxrtl.h>\n";
@@ -2854,17 +2858,19 @@ struct CxxrtlWorker {
 		f << "#include <cxxrtl/capi/cxxrtl_capi_vcd.cc>\n";
 		f << "#endif\n";
 		f << "\n";
-		f << "using namespace cxxrtl_yosys;\n";
-		f << "\n";
-		f << "namespace " << design_ns << " {\n";
-		f << "\n";
-		for (auto module : modules) {
-			if (!split_intf)
-				dump_module_intf(module);
-			dump_module_impl(module);
+		if (split_dir.empty()) {
+			f << "using namespace cxxrtl_yosys;\n";
+			f << "\n";
+			f << "namespace " << design_ns << " {\n";
+			f << "\n";
+			for (auto module : modules) {
+				if (!split_intf)
+					dump_module_intf(module);
+				dump_module_impl(module);
+			}
+			f << "} // namespace " << design_ns << "\n";
+			f << "\n";
 		}
-		f << "} // namespace " << design_ns << "\n";
-		f << "\n";
 		if (top_module != nullptr && debug_info) {
 			f << "extern \"C\"\n";
 			f << "cxxrtl_toplevel " << design_ns << "_create() {\n";
@@ -2878,6 +2884,55 @@ struct CxxrtlWorker {
 		}
 
 		*impl_f << f.str(); f.str("");
+
+		if (!split_dir.empty())
+			dump_split_impl(modules);
+	}
+
+	// Writes the implementation of the modules into files of their own in split_dir, which
+	// only need the interface, so that they can be compiled in parallel. With split_size,
+	// modules are added to a file until it has at least that many kilobytes.
+	void dump_split_impl(const std::vector<RTLIL::Module*> &modules)
+	{
+		pool<std::string> used_names;
+		std::string impl_filename;
+		auto flush = [&]() {
+			f << "} // namespace " << design_ns << "\n";
+			std::ofstream split_f(impl_filename, std::ofstream::trunc);
+			split_f << f.str(); f.str("");
+			if (split_f.fail())
+				log_error("Can't write file `%s': %s\n", impl_filename.c_str(), strerror(errno));
+			impl_filename.clear();
+		};
+
+		for (auto module : modules) {
+			if (module->get_bool_attribute(ID(cxxrtl_blackbox)))
+				continue;
+			if (impl_filename.empty()) {
+				// File names that only differ in the replaced characters get a suffix
+				std::string name = module->name.str().substr(module->name.begins_with("\\") ? 1 : 0);
+				for (auto &c : name)
+					if (!isalnum((unsigned char)c) && c != '_' && c != '-' && c != '.')
+						c = '_';
+				std::string unique_name = name;
+				for (int i = 1; used_names.count(unique_name); i++)
+					unique_name = stringf("%s_%d", name.c_str(), i);
+				used_names.insert(unique_name);
+				impl_filename = split_dir + "/" + unique_name + ".cc";
+
+				f << "#include \"" << basename(intf_filename) << "\"\n";
+				f << "\n";
+				f << "using namespace cxxrtl_yosys;\n";
+				f << "\n";
+				f << "namespace " << design_ns << " {\n";
+				f << "\n";
+			}
+			dump_module_impl(module);
+			if (f.tellp() >= std::streampos(split_size) * 1024)
+				flush();
+		}
+		if (!impl_filename.empty())
+			flush();
 	}
 
 	// Edge-type sync rules require us to emit edge detectors, which require coordination between
@@ -3636,6 +3691,18 @@ struct CxxrtlBackend : public Backend {
 		log("        of the interface is derived from filename of the implementation.\n");
 		log("        otherwise, interface and implementation are generated together.\n");
 		log("\n");
+		log("    -split <dir>\n");
+		log("        like -header, but the interface is written to <dir>/<ns-name>.h, and\n");
+		log("        the implementation of each module to a .cc file of its own in <dir>,\n");
+		log("        so that the modules can be compiled in parallel. the file given to the\n");
+		log("        backend only contains the C API entry point. all the files must be\n");
+		log("        compiled and linked together.\n");
+		log("\n");
+		log("    -split-size <kbytes>\n");
+		log("        with -split, add the implementation of further modules to a file until\n");
+		log("        it has at least <kbytes> kilobytes, instead of starting a new file for\n");
+		log("        each module. the file is named after its first module.\n");
+		log("\n");
 		log("    -namespace <ns-name>\n");
 		log("        place the generated code into namespace <ns-name>. if not specified,\n");
 		log("        \"cxxrtl_design\" is used.\n");
@@ -3779,6 +3846,14 @@ struct CxxrtlBackend : public Backend {
 				worker.split_intf = true;
 				continue;
 			}
+			if (args[argidx] == "-split" && argidx+1 < args.size()) {
+				worker.split_dir = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-split-size" && argidx+1 < args.size()) {
+				worker.split_size = std::stoi(args[++argidx]);
+				continue;
+			}
 			if (args[argidx] == "-namespace" && argidx+1 < args.size()) {
 				worker.design_ns = args[++argidx];
 				continue;
@@ -3846,7 +3921,25 @@ struct CxxrtlBackend : public Backend {
 		}
 
 		std::ofstream intf_f;
-		if (worker.split_intf) {
+		if (!worker.split_dir.empty()) {
+			rewrite_filename(worker.split_dir);
+			if (!create_directory(worker.split_dir))
+				log_cmd_error("Can't create directory `%s'.\n", worker.split_dir.c_str());
+
+			worker.split_intf = true;
+			worker.intf_filename = worker.split_dir + "/" + worker.design_ns + ".h";
+			// included relative to the implementation file when it is in a parent directory
+			worker.split_include = worker.intf_filename;
+			std::string impl_dir = filename.substr(0, filename.rfind('/') + 1);
+			if (!impl_dir.empty() && worker.split_include.compare(0, impl_dir.size(), impl_dir) == 0)
+				worker.split_include = worker.split_include.substr(impl_dir.size());
+			intf_f.open(worker.intf_filename, std::ofstream::trunc);
+			if (intf_f.fail())
+				log_cmd_error("Can't open file `%s' for writing: %s\n",
+				              worker.intf_filename.c_str(), strerror(errno));
+
+			worker.intf_f = &intf_f;
+		} else if (worker.split_intf) {
 			if (filename == "<stdout>")
 				log_cmd_error("Option -header must be used with a filename.\n");
 
@@ -41,7 +41,7 @@ struct JsonWriter
 
 	SigMap sigmap;
 	int sigidcounter;
-	dict<SigBit, string> sigids;
+	dict<SigBit, int> sigids;
 	pool<Aig> aig_models;
 
 	JsonWriter(std::ostream &f, bool use_selection, bool aig_mode, bool compat_int_mode, bool scopeinfo_mode) :
@@ -79,26 +79,28 @@ struct JsonWriter
 		return get_string(RTLIL::unescape_id(name));
 	}
 
-	string get_bits(SigSpec sig)
+	// Writes the bits straight to the output, so that large netlists don't
+	// build a temporary string for every port, connection and netname.
+	void write_bits(SigSpec sig)
 	{
 		bool first = true;
-		string str = "[";
+		f << "[";
 		for (auto bit : sigmap(sig)) {
-			str += first ? " " : ", ";
+			f << (first ? " " : ", ");
 			first = false;
-			if (sigids.count(bit) == 0) {
-				string &s = sigids[bit];
-				if (bit.wire == nullptr) {
-					if (bit == State::S0) s = "\"0\"";
-					else if (bit == State::S1) s = "\"1\"";
-					else if (bit == State::Sz) s = "\"z\"";
-					else s = "\"x\"";
-				} else
-					s = stringf("%d", sigidcounter++);
+			if (bit.wire == nullptr) {
+				if (bit == State::S0) f << "\"0\"";
+				else if (bit == State::S1) f << "\"1\"";
+				else if (bit == State::Sz) f << "\"z\"";
+				else f << "\"x\"";
+				continue;
 			}
-			str += sigids[bit];
+			auto it = sigids.find(bit);
+			if (it == sigids.end())
+				it = sigids.emplace(bit, sigidcounter++).first;
+			f << it->second;
 		}
-		return str + " ]";
+		f << " ]";
 	}
 
 	void write_parameter_value(const Const &value)
@@ -182,7 +184,9 @@ struct JsonWriter
 				f << stringf("          \"upto\": 1,\n");
 			if (w->is_signed)
 				f << stringf("          \"signed\": %d,\n", w->is_signed);
-			f << stringf("          \"bits\": %s\n", get_bits(w).c_str());
+			f << "          \"bits\": ";
+			write_bits(w);
+			f << "\n";
 			f << stringf("        }");
 			first = false;
 		}
@@ -229,7 +233,8 @@ struct JsonWriter
 			bool first2 = true;
 			for (auto &conn : c->connections()) {
 				f << stringf("%s\n", first2 ? "" : ",");
-				f << stringf("            %s: %s", get_name(conn.first).c_str(), get_bits(conn.second).c_str());
+				f << stringf("            %s: ", get_name(conn.first).c_str());
+				write_bits(conn.second);
 				first2 = false;
 			}
 			f << stringf("\n          }\n");
@@ -267,7 +272,9 @@ struct JsonWriter
 			f << stringf("%s\n", first ? "" : ",");
 			f << stringf("        %s: {\n", get_name(w->name).c_str());
 			f << stringf("          \"hide_name\": %s,\n", w->name[0] == '$' ? "1" : "0");
-			f << stringf("          \"bits\": %s,\n", get_bits(w).c_str());
+			f << "          \"bits\": ";
+			write_bits(w);
+			f << ",\n";
 			if (w->start_offset)
 				f << stringf("          \"offset\": %d,\n", w->start_offset);
 			if (w->upto)
@@ -44,6 +44,17 @@ namespace RTLIL_BACKEND {
 	void dump_conn(std::ostream &f, std::string indent, const RTLIL::SigSpec &left, const RTLIL::SigSpec &right);
 	void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module, RTLIL::Design *design, bool only_selected, bool flag_m = true, bool flag_n = false);
 	void dump_design(std::ostream &f, RTLIL::Design *design, bool only_selected, bool flag_m = true, bool flag_n = false);
+
+	// The binary format (write_rtlil -binary) starts with the magic, followed by
+	// one section per module, the module index (autoidx and the name, offset and
+	// size of each section), the string table and the offset of the index. The
+	// file ends with the offset of the string table as 8 bytes in little endian,
+	// so that a reader can find the index and load only the modules it needs.
+	// All the other integers are LEB128 varints (zigzag for signed values), all
+	// the names and string constants refer to the string table, and the wires in
+	// a SigSpec are referred to by their position in the section of the module.
+	extern const char binary_magic[8];
+	void dump_design_binary(std::ostream &f, RTLIL::Design *design, bool only_selected);
 }
 
 YOSYS_NAMESPACE_END
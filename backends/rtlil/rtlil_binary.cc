@@ -0,0 +1,318 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  A binary encoding of the RTLIL representation, for fast checkpoints
+ *  between the stages of a flow. See the comment in rtlil_backend.h for
+ *  the layout of the file.
+ *
+ */
+
+#include "rtlil_backend.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+const char RTLIL_BACKEND::binary_magic[8] = {'\0', 'R', 'T', 'L', 'I', 'L', 'b', '1'};
+
+namespace {
+
+struct BinaryWriter
+{
+	RTLIL::Design *design;
+	bool only_selected;
+
+	std::vector<std::string> strings;
+	dict<int, int> id_strings;
+	dict<std::string, int> const_strings;
+
+	dict<const RTLIL::Wire*, int> wire_index;
+
+	// Only the section being encoded is buffered, everything before it is already
+	// written to the stream
+	std::string buf;
+	size_t written = 0;
+
+	BinaryWriter(RTLIL::Design *design, bool only_selected) : design(design), only_selected(only_selected) { }
+
+	void put_uint(uint64_t value)
+	{
+		while (value >= 0x80) {
+			buf.push_back(char(value | 0x80));
+			value >>= 7;
+		}
+		buf.push_back(char(value));
+	}
+
+	void put_int(int64_t value)
+	{
+		put_uint((uint64_t(value) << 1) ^ uint64_t(value >> 63));
+	}
+
+	void put_byte(uint8_t value)
+	{
+		buf.push_back(char(value));
+	}
+
+	void put_id(RTLIL::IdString id)
+	{
+		auto it = id_strings.find(id.index_);
+		if (it == id_strings.end()) {
+			it = id_strings.emplace(id.index_, GetSize(strings)).first;
+			strings.push_back(id.str());
+		}
+		put_uint(it->second);
+	}
+
+	void put_string(const std::string &str)
+	{
+		auto it = const_strings.find(str);
+		if (it == const_strings.end()) {
+			it = const_strings.emplace(str, GetSize(strings)).first;
+			strings.push_back(str);
+		}
+		put_uint(it->second);
+	}
+
+	void put_bits(const RTLIL::Const &data, int offset, int width)
+	{
+		bool defined = true;
+		for (int i = 0; i < width; i++)
+			if (data[offset+i] != State::S0 && data[offset+i] != State::S1) {
+				defined = false;
+				break;
+			}
+
+		put_uint(width);
+		put_byte(defined ? 0 : 1);
+		if (defined) {
+			for (int i = 0; i < width; i += 8) {
+				uint8_t byte = 0;
+				for (int j = 0; j < 8 && i+j < width; j++)
+					if (data[offset+i+j] == State::S1)
+						byte |= 1 << j;
+				put_byte(byte);
+			}
+		} else {
+			for (int i = 0; i < width; i++)
+				put_byte(data[offset+i]);
+		}
+	}
+
+	void put_const(const RTLIL::Const &data)
+	{
+		// Strings keep their packed form, like in the text format
+		put_uint(data.flags);
+		if (data.flags & RTLIL::CONST_FLAG_STRING)
+			put_string(data.decode_string());
+		else
+			put_bits(data, 0, data.size());
+	}
+
+	void put_attributes(const dict<RTLIL::IdString, RTLIL::Const> &attributes)
+	{
+		put_uint(GetSize(attributes));
+		for (auto &it : attributes) {
+			put_id(it.first);
+			put_const(it.second);
+		}
+	}
+
+	void put_sigspec(const RTLIL::SigSpec &sig)
+	{
+		const std::vector<RTLIL::SigChunk> &chunks = sig.chunks();
+		put_uint(GetSize(chunks));
+		for (auto &chunk : chunks) {
+			if (chunk.wire == nullptr) {
+				put_uint(0);
+				put_bits(chunk.data, 0, chunk.width);
+			} else {
+				bool full = chunk.offset == 0 && chunk.width == chunk.wire->width;
+				put_uint(uint64_t(wire_index.at(chunk.wire) + 1) << 1 | full);
+				if (!full) {
+					put_uint(chunk.offset);
+					put_uint(chunk.width);
+				}
+			}
+		}
+	}
+
+	void put_case(const RTLIL::CaseRule *cs)
+	{
+		put_attributes(cs->attributes);
+		put_uint(GetSize(cs->compare));
+		for (auto &sig : cs->compare)
+			put_sigspec(sig);
+		put_uint(GetSize(cs->actions));
+		for (auto &it : cs->actions) {
+			put_sigspec(it.first);
+			put_sigspec(it.second);
+		}
+		put_uint(GetSize(cs->switches));
+		for (auto sw : cs->switches) {
+			put_attributes(sw->attributes);
+			put_sigspec(sw->signal);
+			put_uint(GetSize(sw->cases));
+			for (auto child : sw->cases)
+				put_case(child);
+		}
+	}
+
+	void put_module(RTLIL::Module *module)
+	{
+		put_id(module->name);
+		put_attributes(module->attributes);
+
+		put_uint(GetSize(module->avail_parameters));
+		for (auto &p : module->avail_parameters) {
+			put_id(p);
+			auto it = module->parameter_default_values.find(p);
+			put_byte(it != module->parameter_default_values.end());
+			if (it != module->parameter_default_values.end())
+				put_const(it->second);
+		}
+
+		wire_index.clear();
+		put_uint(GetSize(module->wires_));
+		for (auto wire : module->wires()) {
+			wire_index[wire] = GetSize(wire_index);
+			put_id(wire->name);
+			put_uint(wire->width);
+			put_int(wire->start_offset);
+			put_uint(wire->port_id);
+			put_byte(wire->port_input | wire->port_output << 1 | wire->upto << 2 | wire->is_signed << 3);
+			put_attributes(wire->attributes);
+		}
+
+		put_uint(GetSize(module->memories));
+		for (auto &it : module->memories) {
+			RTLIL::Memory *memory = it.second;
+			put_id(memory->name);
+			put_uint(memory->width);
+			put_int(memory->start_offset);
+			put_uint(memory->size);
+			put_attributes(memory->attributes);
+		}
+
+		put_uint(GetSize(module->cells_));
+		for (auto cell : module->cells()) {
+			put_id(cell->name);
+			put_id(cell->type);
+			put_attributes(cell->attributes);
+			put_uint(GetSize(cell->parameters));
+			for (auto &it : cell->parameters) {
+				put_id(it.first);
+				put_const(it.second);
+			}
+			put_uint(GetSize(cell->connections()));
+			for (auto &it : cell->connections()) {
+				put_id(it.first);
+				put_sigspec(it.second);
+			}
+		}
+
+		put_uint(GetSize(module->processes));
+		for (auto &it : module->processes) {
+			RTLIL::Process *proc = it.second;
+			put_id(proc->name);
+			put_attributes(proc->attributes);
+			put_case(&proc->root_case);
+			put_uint(GetSize(proc->syncs));
+			for (auto sync : proc->syncs) {
+				put_byte(sync->type);
+				put_sigspec(sync->signal);
+				put_uint(GetSize(sync->actions));
+				for (auto &action : sync->actions) {
+					put_sigspec(action.first);
+					put_sigspec(action.second);
+				}
+				put_uint(GetSize(sync->mem_write_actions));
+				for (auto &act : sync->mem_write_actions) {
+					put_attributes(act.attributes);
+					put_id(act.memid);
+					put_sigspec(act.address);
+					put_sigspec(act.data);
+					put_sigspec(act.enable);
+					put_const(act.priority_mask);
+				}
+			}
+		}
+
+		put_uint(GetSize(module->connections()));
+		for (auto &it : module->connections()) {
+			put_sigspec(it.first);
+			put_sigspec(it.second);
+		}
+	}
+
+	void flush(std::ostream &f)
+	{
+		f.write(buf.data(), buf.size());
+		written += buf.size();
+		buf.clear();
+	}
+
+	void write(std::ostream &f)
+	{
+		buf.assign(RTLIL_BACKEND::binary_magic, sizeof(RTLIL_BACKEND::binary_magic));
+		flush(f);
+
+		std::vector<std::pair<size_t, size_t>> sections;
+		std::vector<RTLIL::Module*> modules;
+		for (auto module : design->modules()) {
+			if (only_selected && !design->selected(module))
+				continue;
+			size_t offset = written;
+			put_module(module);
+			sections.push_back({offset, buf.size()});
+			modules.push_back(module);
+			flush(f);
+		}
+
+		// The module names are interned before the string table is written
+		size_t index_offset = written;
+		put_uint(autoidx);
+		put_uint(GetSize(modules));
+		for (int i = 0; i < GetSize(modules); i++) {
+			put_id(modules[i]->name);
+			put_uint(sections[i].first);
+			put_uint(sections[i].second);
+		}
+
+		size_t table_offset = written + buf.size();
+		put_uint(GetSize(strings));
+		for (auto &str : strings) {
+			put_uint(str.size());
+			buf.append(str);
+		}
+
+		put_uint(index_offset);
+		for (int i = 0; i < 8; i++)
+			put_byte(table_offset >> (8*i));
+		flush(f);
+	}
+};
+
+}
+
+void RTLIL_BACKEND::dump_design_binary(std::ostream &f, RTLIL::Design *design, bool only_selected)
+{
+	BinaryWriter writer(design, only_selected);
+	writer.write(f);
+}
+
+YOSYS_NAMESPACE_END
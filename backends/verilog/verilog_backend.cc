@@ -37,15 +37,24 @@ USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
 bool verbose, norename, noattr, attr2comment, noexpr, nodec, nohex, nostr, extmem, defparam, decimal, siminit, systemverilog, simple_lhs, noparallelcase;
-int auto_name_counter, auto_name_offset, auto_name_digits, extmem_counter;
-dict<RTLIL::IdString, int> auto_name_map;
-std::set<RTLIL::IdString> reg_wires;
+int extmem_counter, inline_expr_depth;
 std::string auto_prefix, extmem_prefix;
 
-RTLIL::Module *active_module;
-dict<RTLIL::SigBit, RTLIL::State> active_initdata;
-SigMap active_sigmap;
-IdString initial_id;
+// The state of the module being written, one per thread when the modules are
+// written in parallel
+YS_THREAD_LOCAL int auto_name_counter, auto_name_offset, auto_name_digits;
+YS_THREAD_LOCAL dict<RTLIL::IdString, int> auto_name_map;
+YS_THREAD_LOCAL dict<RTLIL::IdString, std::string> auto_id_cache;
+YS_THREAD_LOCAL std::set<RTLIL::IdString> reg_wires;
+
+// Wires of -inline-expr that are replaced by the expression of their driver
+YS_THREAD_LOCAL dict<RTLIL::Wire*, RTLIL::Cell*> inline_wires;
+YS_THREAD_LOCAL pool<RTLIL::Cell*> inline_cells;
+
+YS_THREAD_LOCAL RTLIL::Module *active_module;
+YS_THREAD_LOCAL dict<RTLIL::SigBit, RTLIL::State> active_initdata;
+YS_THREAD_LOCAL SigMap active_sigmap;
+YS_THREAD_LOCAL IdString initial_id;
 
 void reset_auto_counter_id(RTLIL::IdString id, bool may_rename)
 {
@@ -72,16 +81,19 @@ void reset_auto_counter_id(RTLIL::IdString id, bool may_rename)
 void reset_auto_counter(RTLIL::Module *module)
 {
 	auto_name_map.clear();
+	auto_id_cache.clear();
 	auto_name_counter = 0;
 	auto_name_offset = 0;
 
 	reset_auto_counter_id(module->name, false);
 
 	for (auto w : module->wires())
-		reset_auto_counter_id(w->name, true);
+		if (!inline_wires.count(w))
+			reset_auto_counter_id(w->name, true);
 
 	for (auto cell : module->cells()) {
-		reset_auto_counter_id(cell->name, true);
+		if (!inline_cells.count(cell))
+			reset_auto_counter_id(cell->name, true);
 		reset_auto_counter_id(cell->type, false);
 	}
 
@@ -102,7 +114,7 @@ std::string next_auto_id()
 	return stringf("%s_%0*d_", auto_prefix.c_str(), auto_name_digits, auto_name_offset + auto_name_counter++);
 }
 
-std::string id(RTLIL::IdString internal_id, bool may_rename = true)
+std::string escape_id(RTLIL::IdString internal_id, bool may_rename)
 {
 	const char *str = internal_id.c_str();
 	bool do_escape = false;
@@ -162,6 +174,23 @@ std::string id(RTLIL::IdString internal_id, bool may_rename = true)
 	return std::string(str);
 }
 
+// The names of the wires are looked up for every reference, so the usual case is
+// cached for the module
+std::string id(RTLIL::IdString internal_id)
+{
+	auto it = auto_id_cache.find(internal_id);
+	if (it == auto_id_cache.end())
+		it = auto_id_cache.emplace(internal_id, escape_id(internal_id, true)).first;
+	return it->second;
+}
+
+std::string id(RTLIL::IdString internal_id, bool may_rename)
+{
+	if (may_rename)
+		return id(internal_id);
+	return escape_id(internal_id, false);
+}
+
 bool is_reg_wire(RTLIL::SigSpec sig, std::string &reg_name)
 {
 	if (!sig.is_chunk() || sig.as_chunk().wire == NULL)
@@ -336,22 +365,21 @@ void dump_sigchunk(std::ostream &f, const RTLIL::SigChunk &chunk, bool no_decima
 	if (chunk.wire == NULL) {
 		dump_const(f, chunk.data, chunk.width, chunk.offset, no_decimal);
 	} else {
-		if (chunk.width == chunk.wire->width && chunk.offset == 0) {
-			f << stringf("%s", id(chunk.wire->name).c_str());
-		} else if (chunk.width == 1) {
+		f << id(chunk.wire->name);
+		if (chunk.width == chunk.wire->width && chunk.offset == 0)
+			return;
+		if (chunk.width == 1) {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << '[' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d]", id(chunk.wire->name).c_str(), chunk.offset + chunk.wire->start_offset);
+				f << '[' << chunk.offset + chunk.wire->start_offset << ']';
 		} else {
 			if (chunk.wire->upto)
-				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
-						(chunk.wire->width - (chunk.offset + chunk.width - 1) - 1) + chunk.wire->start_offset,
-						(chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset);
+				f << '[' << (chunk.wire->width - (chunk.offset + chunk.width - 1) - 1) + chunk.wire->start_offset
+						<< ':' << (chunk.wire->width - chunk.offset - 1) + chunk.wire->start_offset << ']';
 			else
-				f << stringf("%s[%d:%d]", id(chunk.wire->name).c_str(),
-						(chunk.offset + chunk.width - 1) + chunk.wire->start_offset,
-						chunk.offset + chunk.wire->start_offset);
+				f << '[' << (chunk.offset + chunk.width - 1) + chunk.wire->start_offset
+						<< ':' << chunk.offset + chunk.wire->start_offset << ']';
 		}
 	}
 }
@@ -366,13 +394,13 @@ void dump_sigspec(std::ostream &f, const RTLIL::SigSpec &sig)
 	if (sig.is_chunk()) {
 		dump_sigchunk(f, sig.as_chunk());
 	} else {
-		f << stringf("{ ");
+		f << "{ ";
 		for (auto it = sig.chunks().rbegin(); it != sig.chunks().rend(); ++it) {
 			if (it != sig.chunks().rbegin())
-				f << stringf(", ");
+				f << ", ";
 			dump_sigchunk(f, *it, true);
 		}
-		f << stringf(" }");
+		f << " }";
 	}
 }
 
@@ -398,6 +426,9 @@ void dump_attributes(std::ostream &f, std::string indent, dict<RTLIL::IdString,
 
 void dump_wire(std::ostream &f, std::string indent, RTLIL::Wire *wire)
 {
+	if (inline_wires.count(wire))
+		return;
+
 	dump_attributes(f, indent, wire->attributes, "\n", /*modattr=*/false, /*regattr=*/reg_wires.count(wire->name));
 #if 0
 	if (wire->port_input && !wire->port_output)
@@ -1869,6 +1900,189 @@ bool dump_cell_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	return false;
 }
 
+// Only the bitwise operators without any extension of the operands, as the width
+// of an inlined expression is taken from its context.
+bool is_inline_expr_cell(RTLIL::Cell *cell)
+{
+	if (cell->type.in(ID($_NOT_), ID($_AND_), ID($_NAND_), ID($_OR_), ID($_NOR_), ID($_XOR_), ID($_XNOR_), ID($_ANDNOT_), ID($_ORNOT_), ID($_MUX_)))
+		return true;
+	if (cell->type.in(ID($not), ID($and), ID($or), ID($xor), ID($xnor))) {
+		int width = GetSize(cell->getPort(ID::Y));
+		if (GetSize(cell->getPort(ID::A)) != width)
+			return false;
+		return !cell->hasPort(ID::B) || GetSize(cell->getPort(ID::B)) == width;
+	}
+	return false;
+}
+
+void find_inline_exprs(RTLIL::Module *module)
+{
+	inline_wires.clear();
+	inline_cells.clear();
+
+	if (inline_expr_depth <= 0 || noexpr || !module->processes.empty())
+		return;
+
+	dict<RTLIL::Wire*, RTLIL::Cell*> drivers, readers;
+	dict<RTLIL::Wire*, int> num_drivers, num_reads;
+
+	auto count_reads = [&](const RTLIL::SigSpec &sig) {
+		for (auto &chunk : sig.chunks())
+			if (chunk.wire != nullptr)
+				num_reads[chunk.wire]++;
+	};
+
+	// The direction of the ports of the other cells is not known, so they are
+	// all counted as reads.
+	for (auto cell : module->cells()) {
+		bool inline_cell = is_inline_expr_cell(cell);
+		for (auto &conn : cell->connections()) {
+			if (inline_cell && conn.first == ID::Y) {
+				for (auto &chunk : conn.second.chunks())
+					if (chunk.wire != nullptr)
+						num_drivers[chunk.wire]++;
+				if (conn.second.is_wire())
+					drivers[conn.second.as_wire()] = cell;
+				continue;
+			}
+			count_reads(conn.second);
+			if (inline_cell && conn.second.is_wire())
+				readers[conn.second.as_wire()] = cell;
+		}
+	}
+	for (auto &conn : module->connections()) {
+		count_reads(conn.first);
+		count_reads(conn.second);
+	}
+
+	dict<RTLIL::Cell*, std::vector<RTLIL::Wire*>> operands;
+	for (auto &it : drivers) {
+		RTLIL::Wire *wire = it.first;
+		if (wire->name[0] != '$' || wire->port_id != 0 || wire->get_bool_attribute(ID::keep) || wire->attributes.count(ID::init))
+			continue;
+		if (num_drivers.at(wire) != 1 || num_reads[wire] != 1 || !readers.count(wire) || readers.at(wire) == it.second)
+			continue;
+		operands[readers.at(wire)].push_back(wire);
+	}
+
+	// The operands are folded bottom up, as long as the depth of the expression
+	// stays within the limit. Loops through single-use wires are left as they are.
+	dict<RTLIL::Cell*, int> expr_depth;
+	pool<RTLIL::Cell*> on_stack;
+	std::vector<RTLIL::Wire*> no_operands;
+	for (auto cell : module->cells())
+	{
+		if (!is_inline_expr_cell(cell) || expr_depth.count(cell))
+			continue;
+
+		std::vector<std::pair<RTLIL::Cell*, int>> stack;
+		stack.push_back({cell, 0});
+		on_stack.insert(cell);
+		while (!stack.empty())
+		{
+			RTLIL::Cell *current = stack.back().first;
+			auto it = operands.find(current);
+			const std::vector<RTLIL::Wire*> &ops = it != operands.end() ? it->second : no_operands;
+
+			if (stack.back().second < GetSize(ops)) {
+				RTLIL::Cell *child = drivers.at(ops[stack.back().second++]);
+				if (!expr_depth.count(child) && !on_stack.count(child)) {
+					stack.push_back({child, 0});
+					on_stack.insert(child);
+				}
+				continue;
+			}
+
+			int depth = 1;
+			for (auto wire : ops) {
+				RTLIL::Cell *child = drivers.at(wire);
+				auto child_it = expr_depth.find(child);
+				if (child_it == expr_depth.end() || child_it->second >= inline_expr_depth)
+					continue;
+				inline_wires[wire] = child;
+				inline_cells.insert(child);
+				depth = std::max(depth, child_it->second + 1);
+			}
+			expr_depth[current] = depth;
+			on_stack.erase(current);
+			stack.pop_back();
+		}
+	}
+}
+
+void dump_inline_expr(std::ostream &f, RTLIL::Cell *cell);
+
+void dump_inline_operand(std::ostream &f, RTLIL::Cell *cell, RTLIL::IdString port)
+{
+	const RTLIL::SigSpec &sig = cell->getPort(port);
+	if (sig.is_wire() && inline_wires.count(sig.as_wire())) {
+		f << "(";
+		dump_inline_expr(f, inline_wires.at(sig.as_wire()));
+		f << ")";
+	} else
+		dump_sigspec(f, sig);
+}
+
+void dump_inline_expr(std::ostream &f, RTLIL::Cell *cell)
+{
+	if (cell->type.in(ID($not), ID($_NOT_))) {
+		f << "~";
+		dump_inline_operand(f, cell, ID::A);
+		return;
+	}
+
+	if (cell->type == ID($_MUX_)) {
+		dump_inline_operand(f, cell, ID::S);
+		f << " ? ";
+		dump_inline_operand(f, cell, ID::B);
+		f << " : ";
+		dump_inline_operand(f, cell, ID::A);
+		return;
+	}
+
+	bool invert = cell->type.in(ID($_NAND_), ID($_NOR_), ID($_XNOR_));
+	bool invert_b = cell->type.in(ID($_ANDNOT_), ID($_ORNOT_));
+	const char *op = "~^";
+	if (cell->type.in(ID($and), ID($_AND_), ID($_NAND_), ID($_ANDNOT_)))
+		op = "&";
+	if (cell->type.in(ID($or), ID($_OR_), ID($_NOR_), ID($_ORNOT_)))
+		op = "|";
+	if (cell->type.in(ID($xor), ID($_XOR_), ID($_XNOR_)))
+		op = "^";
+
+	if (invert)
+		f << "~(";
+	dump_inline_operand(f, cell, ID::A);
+	f << " " << op << " ";
+	if (invert_b)
+		f << "~(";
+	dump_inline_operand(f, cell, ID::B);
+	if (invert_b)
+		f << ")";
+	if (invert)
+		f << ")";
+}
+
+bool dump_cell_inline_expr(std::ostream &f, std::string indent, RTLIL::Cell *cell)
+{
+	if (inline_wires.empty() || !is_inline_expr_cell(cell))
+		return false;
+
+	bool has_inline_operand = false;
+	for (auto &conn : cell->connections())
+		if (conn.first != ID::Y && conn.second.is_wire() && inline_wires.count(conn.second.as_wire()))
+			has_inline_operand = true;
+	if (!has_inline_operand)
+		return false;
+
+	f << stringf("%s" "assign ", indent.c_str());
+	dump_sigspec(f, cell->getPort(ID::Y));
+	f << " = ";
+	dump_inline_expr(f, cell);
+	f << ";\n";
+	return true;
+}
+
 void dump_cell(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 {
 	// To keep the output compatible with other tools we ignore $scopeinfo
@@ -1882,7 +2096,12 @@ void dump_cell(std::ostream &f, std::string indent, RTLIL::Cell *cell)
 	if (cell->is_mem_cell())
 		return;
 
+	if (inline_cells.count(cell))
+		return;
+
 	if (cell->type[0] == '$' && !noexpr) {
+		if (dump_cell_inline_expr(f, indent, cell))
+			return;
 		if (dump_cell_expr(f, indent, cell))
 			return;
 	}
@@ -2269,6 +2488,7 @@ void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module)
 	std::map<std::pair<RTLIL::SigSpec, RTLIL::Const>, std::vector<const RTLIL::Cell*>> sync_effect_cells;
 
 	reg_wires.clear();
+	find_inline_exprs(module);
 	reset_auto_counter(module);
 	active_module = module;
 	active_sigmap.set(module);
@@ -2371,6 +2591,8 @@ void dump_module(std::ostream &f, std::string indent, RTLIL::Module *module)
 	active_module = NULL;
 	active_sigmap.clear();
 	active_initdata.clear();
+	inline_wires.clear();
+	inline_cells.clear();
 }
 
 struct VerilogBackend : public Backend {
@@ -2457,9 +2679,26 @@ struct VerilogBackend : public Backend {
 		log("        only write selected modules. modules must be selected entirely or\n");
 		log("        not at all.\n");
 		log("\n");
+		log("    -inline-expr <depth>\n");
+		log("        fold the expressions of internal ($-named) wires that are driven by a\n");
+		log("        bitwise gate and read exactly once, by another such gate, into the\n");
+		log("        expression of the reader, up to <depth> operators per expression.\n");
+		log("        this reduces the number of wires and assignments, e.g. for Verilator.\n");
+		log("        wires with the keep attribute are not folded, and the attributes of\n");
+		log("        the folded cells are not written.\n");
+		log("\n");
+		log("    -split-dir <dir>\n");
+		log("        write each module to its own file <dir>/<module>.v, and only a list of\n");
+		log("        `include directives for these files to the output file. the paths are\n");
+		log("        relative to the directory of the output file if <dir> is inside it.\n");
+		log("\n");
 		log("    -v\n");
 		log("        verbose output (print new names of all renamed wires and cells)\n");
 		log("\n");
+		log("The modules are written on up to 'yosys -j' threads when yosys is built with\n");
+		log("thread support, except with -extmem. The output does not depend on the\n");
+		log("number of threads.\n");
+		log("\n");
 		log("Note that RTLIL processes can't always be mapped directly to Verilog\n");
 		log("always blocks. This frontend should only be used to export an RTLIL\n");
 		log("netlist, i.e. after the \"proc\" pass has been used to convert all\n");
@@ -2486,9 +2725,11 @@ struct VerilogBackend : public Backend {
 		simple_lhs = false;
 		noparallelcase = false;
 		auto_prefix = "";
+		inline_expr_depth = 0;
 
 		bool blackboxes = false;
 		bool selected = false;
+		std::string split_dir;
 
 		auto_name_map.clear();
 		reg_wires.clear();
@@ -2565,6 +2806,14 @@ struct VerilogBackend : public Backend {
 				simple_lhs = true;
 				continue;
 			}
+			if (arg == "-inline-expr" && argidx+1 < args.size()) {
+				inline_expr_depth = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (arg == "-split-dir" && argidx+1 < args.size()) {
+				split_dir = args[++argidx];
+				continue;
+			}
 			if (arg == "-v") {
 				verbose = true;
 				continue;
@@ -2589,7 +2838,7 @@ struct VerilogBackend : public Backend {
 
 		design->sort();
 
-		*f << stringf("/* Generated by %s */\n", yosys_version_str);
+		std::vector<RTLIL::Module*> modules;
 		for (auto module : design->modules()) {
 			if (module->get_blackbox_attribute() != blackboxes)
 				continue;
@@ -2598,11 +2847,72 @@ struct VerilogBackend : public Backend {
 					log_cmd_error("Can't handle partially selected module %s!\n", log_id(module->name));
 				continue;
 			}
-			log("Dumping module `%s'.\n", module->name.c_str());
-			dump_module(*f, "", module);
+			modules.push_back(module);
 		}
 
+		*f << stringf("/* Generated by %s */\n", yosys_version_str);
+
+		dict<RTLIL::Module*, std::string> module_filenames;
+		if (!split_dir.empty()) {
+			rewrite_filename(split_dir);
+			if (!create_directory(split_dir))
+				log_cmd_error("Can't create directory `%s'.\n", split_dir.c_str());
+			// Included relative to the output file when it is in a parent directory
+			std::string output_dir = filename == "<stdout>" ? "" : filename.substr(0, filename.rfind('/') + 1);
+			// File names that only differ in the replaced characters get a suffix
+			pool<std::string> used_names;
+			for (auto module : modules) {
+				std::string name = module->name.str().substr(module->name.begins_with("\\") ? 1 : 0);
+				for (auto &c : name)
+					if (!isalnum((unsigned char)c) && c != '_' && c != '-' && c != '.')
+						c = '_';
+				std::string unique_name = name;
+				for (int i = 1; used_names.count(unique_name); i++)
+					unique_name = stringf("%s_%d", name.c_str(), i);
+				used_names.insert(unique_name);
+				module_filenames[module] = split_dir + "/" + unique_name + ".v";
+				std::string include_name = module_filenames.at(module);
+				if (!output_dir.empty() && include_name.compare(0, output_dir.size(), output_dir) == 0)
+					include_name = include_name.substr(output_dir.size());
+				*f << stringf("`include \"%s\"\n", include_name.c_str());
+			}
+		}
+
+		// When the modules are written in parallel, each one is formatted into its
+		// own buffer and the buffers are written in module order.
+		bool buffered = split_dir.empty() && yosys_jobs > 1 && !extmem;
+		std::vector<std::stringstream> buffers(buffered ? GetSize(modules) : 0);
+		dict<RTLIL::Module*, int> module_index;
+		for (int i = 0; i < GetSize(modules); i++)
+			module_index[modules[i]] = i;
+
+		auto dump = [&](RTLIL::Module *module) {
+			log("Dumping module `%s'.\n", module->name.c_str());
+			if (!split_dir.empty()) {
+				const std::string &module_filename = module_filenames.at(module);
+				std::ofstream ff(module_filename);
+				if (ff.fail())
+					log_error("Can't open file `%s' for writing: %s\n", module_filename.c_str(), strerror(errno));
+				ff << stringf("/* Generated by %s */\n", yosys_version_str);
+				dump_module(ff, "", module);
+			} else if (buffered)
+				dump_module(buffers[module_index.at(module)], "", module);
+			else
+				dump_module(*f, "", module);
+		};
+
+		// The memory files of -extmem are numbered in module order
+		if (extmem) {
+			for (auto module : modules)
+				dump(module);
+		} else
+			ModulePass::run_on_modules(modules, dump);
+
+		for (auto &buf : buffers)
+			*f << buf.rdbuf();
+
 		auto_name_map.clear();
+		auto_id_cache.clear();
 		reg_wires.clear();
 	}
 } VerilogBackend;
@@ -232,6 +232,7 @@ struct Xaiger2Frontend : public Frontend {
 
 					log_assert(box_ci_idx == (int) box_outputs);
 					ci_counter += box_ci_idx;
+					module->touch();
 				}
 				log_assert(pi_num + ci_counter == ci_num);
 			} else if (c == '\n') {
@@ -440,6 +441,7 @@ struct Xaiger2Frontend : public Frontend {
 					log_error("Map file references non-existent box port bit %s/%s[%d]\n",
 							  box_name.c_str(), box_port.c_str(), poffset);
 				port[poffset] = bits[lit];
+				module->touch();
 			} else {
 				std::string scratch;
 				std::getline(map_file, scratch);
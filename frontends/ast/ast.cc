@@ -30,6 +30,8 @@
 #include "kernel/yosys.h"
 #include "libs/sha1/sha1.h"
 #include "ast.h"
+#include "frontends/rtlil/rtlil_frontend.h"
+#include "backends/rtlil/rtlil_backend.h"
 
 YOSYS_NAMESPACE_BEGIN
 
@@ -1650,6 +1652,150 @@ void AstModule::expand_interfaces(RTLIL::Design *design, const dict<RTLIL::IdStr
 	new_module->set_bool_attribute(ID::interfaces_replaced_in_module);
 }
 
+// The derive cache is a directory with the RTLIL of the modules derived by earlier
+// runs, in the format of write_rtlil -binary. It is set with the scratchpad variable
+// ast.derive_cache (see hierarchy -derive-cache). A file is named after the hash of
+// everything the derivation depends on: the AST with the parameters substituted,
+// the frontend options of the module and the Yosys version. Modules that look up
+// other modules while they are simplified are not stored.
+
+static void serialize_ast(std::string &buf, const AstNode *node)
+{
+	auto put_int = [&](int64_t value) { buf.append(reinterpret_cast<const char*>(&value), sizeof(value)); };
+	auto put_str = [&](const std::string &str) { put_int(str.size()); buf.append(str); };
+
+	if (node == nullptr) {
+		put_int(-1);
+		return;
+	}
+
+	put_int(node->type);
+	put_str(node->str);
+	put_int(GetSize(node->bits));
+	for (auto bit : node->bits)
+		buf.push_back(char(bit));
+	put_int(node->is_input | node->is_output << 1 | node->is_reg << 2 | node->is_logic << 3 | node->is_signed << 4 |
+			node->is_string << 5 | node->is_wand << 6 | node->is_wor << 7 | node->range_valid << 8 | node->range_swapped << 9 |
+			node->was_checked << 10 | node->is_unsized << 11 | node->is_custom_type << 12 | node->is_enum << 13 |
+			node->basic_prep << 14 | node->lookahead << 15 | node->in_lvalue << 16 | node->in_param << 17 |
+			node->in_lvalue_from_above << 18 | node->in_param_from_above << 19 | (node->id2ast != nullptr) << 20);
+	put_int(node->port_id);
+	put_int(node->range_left);
+	put_int(node->range_right);
+	put_int(node->integer);
+	buf.append(reinterpret_cast<const char*>(&node->realvalue), sizeof(node->realvalue));
+	put_int(GetSize(node->dimensions));
+	for (auto &dim : node->dimensions) {
+		put_int(dim.range_right);
+		put_int(dim.range_width);
+		put_int(dim.range_swapped);
+	}
+	put_int(node->unpacked_dimensions);
+	put_str(node->filename);
+	put_int(node->location.first_line);
+	put_int(node->location.first_column);
+	put_int(node->location.last_line);
+	put_int(node->location.last_column);
+
+	put_int(GetSize(node->attributes));
+	for (auto &it : node->attributes) {
+		put_str(it.first.str());
+		serialize_ast(buf, it.second);
+	}
+	put_int(GetSize(node->children));
+	for (auto child : node->children)
+		serialize_ast(buf, child);
+}
+
+static std::string derive_cache_file(RTLIL::Design *design, const AstModule *module, const AstNode *new_ast)
+{
+	std::string dir = design->scratchpad_get_string("ast.derive_cache");
+	if (dir.empty())
+		return std::string();
+
+	std::string buf = stringf("%s\n%d%d%d%d%d%d%d%d%d%d%d\n", yosys_version_str, module->nolatches, module->nomeminit,
+			module->nomem2reg, module->mem2reg, module->noblackbox, module->lib, module->nowb, module->noopt,
+			module->icells, module->pwires, module->autowire);
+	serialize_ast(buf, new_ast);
+	return dir + "/" + sha1(buf) + ".il";
+}
+
+static bool derive_cache_load(RTLIL::Design *design, const std::string &filename, AstModule *module, AstNode *new_ast)
+{
+	std::ifstream f(filename, std::ios::binary);
+	std::istream *fp = &f;
+	if (f.fail() || !RTLIL_FRONTEND::is_binary(fp))
+		return false;
+
+	bool bak_nooverwrite = RTLIL_FRONTEND::flag_nooverwrite;
+	bool bak_overwrite = RTLIL_FRONTEND::flag_overwrite;
+	bool bak_lib = RTLIL_FRONTEND::flag_lib;
+	RTLIL_FRONTEND::flag_nooverwrite = false;
+	RTLIL_FRONTEND::flag_overwrite = false;
+	RTLIL_FRONTEND::flag_lib = false;
+
+	RTLIL::Design cache_design;
+	RTLIL_FRONTEND::read_binary(fp, filename, &cache_design);
+
+	RTLIL_FRONTEND::flag_nooverwrite = bak_nooverwrite;
+	RTLIL_FRONTEND::flag_overwrite = bak_overwrite;
+	RTLIL_FRONTEND::flag_lib = bak_lib;
+
+	RTLIL::Module *cached = cache_design.module(new_ast->str);
+	if (cached == nullptr)
+		return false;
+
+	// The same as process_module() leaves behind, with the AST before simplification
+	AstModule *new_module = new AstModule;
+	new_module->name = new_ast->str;
+	cached->cloneInto(new_module);
+	new_module->ast = new_ast;
+	new_module->nolatches = module->nolatches;
+	new_module->nomeminit = module->nomeminit;
+	new_module->nomem2reg = module->nomem2reg;
+	new_module->mem2reg = module->mem2reg;
+	new_module->noblackbox = module->noblackbox;
+	new_module->lib = module->lib;
+	new_module->nowb = module->nowb;
+	new_module->noopt = module->noopt;
+	new_module->icells = module->icells;
+	new_module->pwires = module->pwires;
+	new_module->autowire = module->autowire;
+	design->add(new_module);
+	return true;
+}
+
+static void derive_cache_store(RTLIL::Design *design, const std::string &filename, RTLIL::Module *module)
+{
+	std::string dir = filename.substr(0, filename.rfind('/'));
+	if (!create_directory(dir)) {
+		log_warning("Can't create derive cache directory `%s'.\n", dir.c_str());
+		return;
+	}
+
+	// Written under a temporary name, so that other runs never see a partial file
+	std::string temp_filename = make_temp_file(dir + "/derive_XXXXXX");
+	std::ofstream f(temp_filename, std::ios::binary);
+	RTLIL::Selection selection(false);
+	selection.select(module);
+	design->selection_stack.push_back(selection);
+	RTLIL_BACKEND::dump_design_binary(f, design, true);
+	design->selection_stack.pop_back();
+	f.close();
+
+#if !defined(_WIN32)
+	// Like the liberty cache, shared with other users at the permissions of a normally created file
+	mode_t mask = umask(0);
+	umask(mask);
+	chmod(temp_filename.c_str(), 0644 & ~mask);
+#endif
+
+	if (f.fail() || rename(temp_filename.c_str(), filename.c_str()) != 0) {
+		log_warning("Can't write derive cache file `%s'.\n", filename.c_str());
+		remove(temp_filename.c_str());
+	}
+}
+
 // create a new parametric module (when needed) and return the name of the generated module - WITH support for interfaces
 // This method is used to explode the interface when the interface is a port of the module (not instantiated inside)
 RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdString, RTLIL::Const> &parameters, const dict<RTLIL::IdString, RTLIL::Module*> &interfaces, const dict<RTLIL::IdString, RTLIL::IdString> &modports, bool /*mayfail*/)
@@ -1697,8 +1843,18 @@ RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdStr
 			explode_interface_port(new_ast, intfmodule, intfname, modport);
 		}
 
+		// Without interface ports, the derived module only depends on its AST
+		std::string cache_file = has_interfaces ? std::string() : derive_cache_file(design, this, new_ast);
+		if (!cache_file.empty() && derive_cache_load(design, cache_file, this, new_ast)) {
+			log("Loaded RTLIL representation for module `%s' from `%s'.\n", modname.c_str(), cache_file.c_str());
+			return modname;
+		}
+
+		unsigned int lookups = simplify_design_lookups();
 		process_module(design, new_ast, false);
 		design->module(modname)->check();
+		if (!cache_file.empty() && simplify_design_lookups() == lookups)
+			derive_cache_store(design, cache_file, design->module(modname));
 
 		RTLIL::Module* mod = design->module(modname);
 
@@ -1748,8 +1904,18 @@ RTLIL::IdString AstModule::derive(RTLIL::Design *design, const dict<RTLIL::IdStr
 
 	if (!design->has(modname) && new_ast) {
 		new_ast->str = modname;
-		process_module(design, new_ast, false, NULL, quiet);
-		design->module(modname)->check();
+		std::string cache_file = derive_cache_file(design, this, new_ast);
+		if (!cache_file.empty() && derive_cache_load(design, cache_file, this, new_ast)) {
+			if (!quiet)
+				log("Loaded RTLIL representation for module `%s' from `%s'.\n", modname.c_str(), cache_file.c_str());
+			new_ast = nullptr;
+		} else {
+			unsigned int lookups = simplify_design_lookups();
+			process_module(design, new_ast, false, NULL, quiet);
+			design->module(modname)->check();
+			if (!cache_file.empty() && simplify_design_lookups() == lookups)
+				derive_cache_store(design, cache_file, design->module(modname));
+		}
 	} else if (!quiet) {
 		log("Found cached RTLIL representation for module `%s'.\n", modname.c_str());
 	}
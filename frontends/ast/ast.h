@@ -435,6 +435,9 @@ namespace AST
 	// used to provide simplify() access to the current design for looking up
 	// modules, ports, wires, etc.
 	void set_simplify_design_context(const RTLIL::Design *design);
+
+	// number of modules looked up in the design context so far
+	unsigned int simplify_design_lookups();
 }
 
 namespace AST_INTERNAL
@@ -609,9 +609,18 @@ void AST::set_simplify_design_context(const RTLIL::Design *design)
 	simplify_design_context = design;
 }
 
+// counted so that AstModule::derive() can tell whether a module depends on other modules
+static unsigned int simplify_design_lookup_count = 0;
+
+unsigned int AST::simplify_design_lookups()
+{
+	return simplify_design_lookup_count;
+}
+
 // lookup the module with the given name in the current design context
 static const RTLIL::Module* lookup_module(const std::string &name)
 {
+	simplify_design_lookup_count++;
 	return simplify_design_context->module(name);
 }
 
@@ -19,8 +19,79 @@
 
 #include "kernel/yosys.h"
 
+#if !defined(_WIN32)
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
 YOSYS_NAMESPACE_BEGIN
 
+// The contents of the file, mapped into memory when it is a plain file, so
+// that netlists of several GB don't need a copy of the text in the heap.
+struct JsonInput
+{
+	std::string buffer;
+	const char *data = nullptr;
+	size_t size = 0;
+	void *mapped = nullptr;
+
+	JsonInput(std::istream *f, const std::string &filename)
+	{
+#if !defined(_WIN32)
+		if (dynamic_cast<std::ifstream*>(f) != nullptr) {
+			int fd = open(filename.c_str(), O_RDONLY);
+			struct stat st;
+			if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+				void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (ptr != MAP_FAILED) {
+					mapped = ptr;
+					data = static_cast<const char*>(ptr);
+					size = st.st_size;
+				}
+			}
+			if (fd >= 0)
+				close(fd);
+			if (mapped != nullptr)
+				return;
+		}
+#endif
+		std::stringstream ss;
+		ss << f->rdbuf();
+		buffer = ss.str();
+		data = buffer.data();
+		size = buffer.size();
+	}
+
+	~JsonInput()
+	{
+#if !defined(_WIN32)
+		if (mapped != nullptr)
+			munmap(mapped, size);
+#endif
+	}
+};
+
+// Character source for the parser, with the get()/unget() of an istream.
+struct JsonStream
+{
+	const char *ptr, *end;
+
+	JsonStream(const JsonInput &input) : ptr(input.data), end(input.data + input.size) { }
+
+	int get() { return ptr == end ? EOF : (unsigned char)*ptr++; }
+	void unget() { ptr--; }
+
+	// Returns the next character after the given separators, without consuming it
+	int peek(const char *separators)
+	{
+		while (ptr != end && strchr(separators, *ptr) != nullptr)
+			ptr++;
+		return ptr == end ? EOF : (unsigned char)*ptr;
+	}
+};
+
 struct JsonNode
 {
 	char type; // S=String, N=Number, A=Array, D=Dict
@@ -30,7 +101,7 @@ struct JsonNode
 	dict<string, JsonNode*> data_dict;
 	vector<string> data_dict_keys;
 
-	JsonNode(std::istream &f)
+	JsonNode(JsonStream &f)
 	{
 		type = 0;
 		data_number = 0;
@@ -287,27 +358,39 @@ void json_parse_attr_param(dict<IdString, Const> &results, JsonNode *node)
 	}
 }
 
-void json_import(Design *design, string &modname, JsonNode *node)
+// Imports the entries of a module as soon as they are parsed, so that only the
+// tree of one net or cell is held at a time. The "ports" and "memories" dicts
+// are small and parsed as a whole.
+struct JsonModuleImporter
 {
-	log("Importing module %s from JSON tree.\n", modname.c_str());
-
-	Module *module = new RTLIL::Module;
-	module->name = RTLIL::escape_id(modname.c_str());
-
-	if (design->module(module->name))
-		log_error("Re-definition of module %s.\n", log_id(module->name));
+	Module *module;
+	dict<int, SigBit> signal_bits;
 
-	design->add(module);
+	// Wires created for the bits of cell connections that are not bound yet, which
+	// are replaced by the bits of the nets that are bound to them later
+	pool<Wire*> placeholders;
+	dict<SigBit, SigBit> placeholder_map;
 
-	if (node->data_dict.count("attributes"))
-		json_parse_attr_param(module->attributes, node->data_dict.at("attributes"));
+	std::vector<Wire*> port_wires, netname_wires, placeholder_wires;
 
-	dict<int, SigBit> signal_bits;
+	JsonModuleImporter(Module *module) : module(module) { }
 
-	if (node->data_dict.count("ports"))
+	// Returns true if `bitidx` is bound to a bit other than a placeholder. A
+	// placeholder is replaced by `sigbit`, which the caller binds instead.
+	bool bound(int bitidx, SigBit sigbit)
 	{
-		JsonNode *ports_node = node->data_dict.at("ports");
+		auto it = signal_bits.find(bitidx);
+		if (it == signal_bits.end())
+			return false;
+		if (!placeholders.count(it->second.wire))
+			return true;
+		placeholders.erase(it->second.wire);
+		placeholder_map[it->second] = sigbit;
+		return false;
+	}
 
+	void import_ports(JsonNode *ports_node)
+	{
 		if (ports_node->type != 'D')
 			log_error("JSON ports node is not a dictionary.\n");
 
@@ -336,8 +419,10 @@ void json_import(Design *design, string &modname, JsonNode *node)
 
 			Wire *port_wire = module->wire(port_name);
 
-			if (port_wire == nullptr)
+			if (port_wire == nullptr) {
 				port_wire = module->addWire(port_name, GetSize(port_bits_node->data_array));
+				port_wires.push_back(port_wire);
+			}
 
 			if (port_node->data_dict.count("upto") != 0) {
 				JsonNode *val = port_node->data_dict.at("upto");
@@ -391,7 +476,7 @@ void json_import(Design *design, string &modname, JsonNode *node)
 				} else
 				if (bitval_node->type == 'N') {
 					int bitidx = bitval_node->data_number;
-					if (signal_bits.count(bitidx)) {
+					if (bound(bitidx, sigbit)) {
 						if (port_wire->port_output) {
 							module->connect(sigbit, signal_bits.at(bitidx));
 						} else {
@@ -409,169 +494,151 @@ void json_import(Design *design, string &modname, JsonNode *node)
 		module->fixup_ports();
 	}
 
-	if (node->data_dict.count("netnames"))
+	void import_netname(IdString net_name, JsonNode *net_node)
 	{
-		JsonNode *netnames_node = node->data_dict.at("netnames");
-
-		if (netnames_node->type != 'D')
-			log_error("JSON netnames node is not a dictionary.\n");
+		if (net_node->type != 'D')
+			log_error("JSON netname node '%s' is not a dictionary.\n", log_id(net_name));
 
-		for (auto &net : netnames_node->data_dict)
-		{
-			IdString net_name = RTLIL::escape_id(net.first.c_str());
-			JsonNode *net_node = net.second;
-
-			if (net_node->type != 'D')
-				log_error("JSON netname node '%s' is not a dictionary.\n", log_id(net_name));
-
-			if (net_node->data_dict.count("bits") == 0)
-				log_error("JSON netname node '%s' has no bits attribute.\n", log_id(net_name));
+		if (net_node->data_dict.count("bits") == 0)
+			log_error("JSON netname node '%s' has no bits attribute.\n", log_id(net_name));
 
-			JsonNode *bits_node = net_node->data_dict.at("bits");
+		JsonNode *bits_node = net_node->data_dict.at("bits");
 
-			if (bits_node->type != 'A')
-				log_error("JSON netname node '%s' has non-array bits attribute.\n", log_id(net_name));
+		if (bits_node->type != 'A')
+			log_error("JSON netname node '%s' has non-array bits attribute.\n", log_id(net_name));
 
-			Wire *wire = module->wire(net_name);
+		Wire *wire = module->wire(net_name);
 
-			if (wire == nullptr)
-				wire = module->addWire(net_name, GetSize(bits_node->data_array));
-
-			if (net_node->data_dict.count("upto") != 0) {
-				JsonNode *val = net_node->data_dict.at("upto");
-				if (val->type == 'N')
-					wire->upto = val->data_number != 0;
-			}
-
-			if (net_node->data_dict.count("offset") != 0) {
-				JsonNode *val = net_node->data_dict.at("offset");
-				if (val->type == 'N')
-					wire->start_offset = val->data_number;
-			}
+		if (wire == nullptr) {
+			wire = module->addWire(net_name, GetSize(bits_node->data_array));
+			netname_wires.push_back(wire);
+		}
 
-			for (int i = 0; i < GetSize(bits_node->data_array); i++)
-			{
-				JsonNode *bitval_node = bits_node->data_array.at(i);
-				SigBit sigbit(wire, i);
+		if (net_node->data_dict.count("upto") != 0) {
+			JsonNode *val = net_node->data_dict.at("upto");
+			if (val->type == 'N')
+				wire->upto = val->data_number != 0;
+		}
 
-				if (bitval_node->type == 'S') {
-					if (bitval_node->data_string == "0")
-						module->connect(sigbit, State::S0);
-					else if (bitval_node->data_string == "1")
-						module->connect(sigbit, State::S1);
-					else if (bitval_node->data_string == "x")
-						module->connect(sigbit, State::Sx);
-					else if (bitval_node->data_string == "z")
-						module->connect(sigbit, State::Sz);
-					else
-						log_error("JSON netname node '%s' has invalid '%s' bit string value on bit %d.\n",
-								log_id(net_name), bitval_node->data_string.c_str(), i);
-				} else
-				if (bitval_node->type == 'N') {
-					int bitidx = bitval_node->data_number;
-					if (signal_bits.count(bitidx)) {
-						if (sigbit != signal_bits.at(bitidx))
-							module->connect(sigbit, signal_bits.at(bitidx));
-					} else {
-						signal_bits[bitidx] = sigbit;
-					}
-				} else
-					log_error("JSON netname node '%s' has invalid bit value on bit %d.\n", log_id(net_name), i);
-			}
+		if (net_node->data_dict.count("offset") != 0) {
+			JsonNode *val = net_node->data_dict.at("offset");
+			if (val->type == 'N')
+				wire->start_offset = val->data_number;
+		}
 
-			if (net_node->data_dict.count("attributes"))
-				json_parse_attr_param(wire->attributes, net_node->data_dict.at("attributes"));
+		for (int i = 0; i < GetSize(bits_node->data_array); i++)
+		{
+			JsonNode *bitval_node = bits_node->data_array.at(i);
+			SigBit sigbit(wire, i);
+
+			if (bitval_node->type == 'S') {
+				if (bitval_node->data_string == "0")
+					module->connect(sigbit, State::S0);
+				else if (bitval_node->data_string == "1")
+					module->connect(sigbit, State::S1);
+				else if (bitval_node->data_string == "x")
+					module->connect(sigbit, State::Sx);
+				else if (bitval_node->data_string == "z")
+					module->connect(sigbit, State::Sz);
+				else
+					log_error("JSON netname node '%s' has invalid '%s' bit string value on bit %d.\n",
+							log_id(net_name), bitval_node->data_string.c_str(), i);
+			} else
+			if (bitval_node->type == 'N') {
+				int bitidx = bitval_node->data_number;
+				if (bound(bitidx, sigbit)) {
+					if (sigbit != signal_bits.at(bitidx))
+						module->connect(sigbit, signal_bits.at(bitidx));
+				} else {
+					signal_bits[bitidx] = sigbit;
+				}
+			} else
+				log_error("JSON netname node '%s' has invalid bit value on bit %d.\n", log_id(net_name), i);
 		}
+
+		if (net_node->data_dict.count("attributes"))
+			json_parse_attr_param(wire->attributes, net_node->data_dict.at("attributes"));
 	}
 
-	if (node->data_dict.count("cells"))
+	void import_cell(IdString cell_name, JsonNode *cell_node)
 	{
-		JsonNode *cells_node = node->data_dict.at("cells");
+		if (cell_node->type != 'D')
+			log_error("JSON cells node '%s' is not a dictionary.\n", log_id(cell_name));
 
-		if (cells_node->type != 'D')
-			log_error("JSON cells node is not a dictionary.\n");
+		if (cell_node->data_dict.count("type") == 0)
+			log_error("JSON cells node '%s' has no type attribute.\n", log_id(cell_name));
 
-		for (auto &cell_node_it : cells_node->data_dict)
-		{
-			IdString cell_name = RTLIL::escape_id(cell_node_it.first.c_str());
-			JsonNode *cell_node = cell_node_it.second;
+		JsonNode *type_node = cell_node->data_dict.at("type");
 
-			if (cell_node->type != 'D')
-				log_error("JSON cells node '%s' is not a dictionary.\n", log_id(cell_name));
+		if (type_node->type != 'S')
+			log_error("JSON cells node '%s' has a non-string type.\n", log_id(cell_name));
 
-			if (cell_node->data_dict.count("type") == 0)
-				log_error("JSON cells node '%s' has no type attribute.\n", log_id(cell_name));
+		IdString cell_type = RTLIL::escape_id(type_node->data_string.c_str());
 
-			JsonNode *type_node = cell_node->data_dict.at("type");
+		Cell *cell = module->addCell(cell_name, cell_type);
 
-			if (type_node->type != 'S')
-				log_error("JSON cells node '%s' has a non-string type.\n", log_id(cell_name));
+		if (cell_node->data_dict.count("connections") == 0)
+			log_error("JSON cells node '%s' has no connections attribute.\n", log_id(cell_name));
 
-			IdString cell_type = RTLIL::escape_id(type_node->data_string.c_str());
+		JsonNode *connections_node = cell_node->data_dict.at("connections");
 
-			Cell *cell = module->addCell(cell_name, cell_type);
+		if (connections_node->type != 'D')
+			log_error("JSON cells node '%s' has non-dictionary connections attribute.\n", log_id(cell_name));
 
-			if (cell_node->data_dict.count("connections") == 0)
-				log_error("JSON cells node '%s' has no connections attribute.\n", log_id(cell_name));
+		for (auto &conn_it : connections_node->data_dict)
+		{
+			IdString conn_name = RTLIL::escape_id(conn_it.first.c_str());
+			JsonNode *conn_node = conn_it.second;
 
-			JsonNode *connections_node = cell_node->data_dict.at("connections");
+			if (conn_node->type != 'A')
+				log_error("JSON cells node '%s' connection '%s' is not an array.\n", log_id(cell_name), log_id(conn_name));
 
-			if (connections_node->type != 'D')
-				log_error("JSON cells node '%s' has non-dictionary connections attribute.\n", log_id(cell_name));
+			SigSpec sig;
 
-			for (auto &conn_it : connections_node->data_dict)
+			for (int i = 0; i < GetSize(conn_node->data_array); i++)
 			{
-				IdString conn_name = RTLIL::escape_id(conn_it.first.c_str());
-				JsonNode *conn_node = conn_it.second;
-
-				if (conn_node->type != 'A')
-					log_error("JSON cells node '%s' connection '%s' is not an array.\n", log_id(cell_name), log_id(conn_name));
-
-				SigSpec sig;
-
-				for (int i = 0; i < GetSize(conn_node->data_array); i++)
-				{
-					JsonNode *bitval_node = conn_node->data_array.at(i);
-
-					if (bitval_node->type == 'S') {
-						if (bitval_node->data_string == "0")
-							sig.append(State::S0);
-						else if (bitval_node->data_string == "1")
-							sig.append(State::S1);
-						else if (bitval_node->data_string == "x")
-							sig.append(State::Sx);
-						else if (bitval_node->data_string == "z")
-							sig.append(State::Sz);
-						else
-							log_error("JSON cells node '%s' connection '%s' has invalid '%s' bit string value on bit %d.\n",
-									log_id(cell_name), log_id(conn_name), bitval_node->data_string.c_str(), i);
-					} else
-					if (bitval_node->type == 'N') {
-						int bitidx = bitval_node->data_number;
-						if (signal_bits.count(bitidx) == 0)
-							signal_bits[bitidx] = module->addWire(NEW_ID);
-						sig.append(signal_bits.at(bitidx));
-					} else
-						log_error("JSON cells node '%s' connection '%s' has invalid bit value on bit %d.\n",
-								log_id(cell_name), log_id(conn_name), i);
+				JsonNode *bitval_node = conn_node->data_array.at(i);
 
-				}
+				if (bitval_node->type == 'S') {
+					if (bitval_node->data_string == "0")
+						sig.append(State::S0);
+					else if (bitval_node->data_string == "1")
+						sig.append(State::S1);
+					else if (bitval_node->data_string == "x")
+						sig.append(State::Sx);
+					else if (bitval_node->data_string == "z")
+						sig.append(State::Sz);
+					else
+						log_error("JSON cells node '%s' connection '%s' has invalid '%s' bit string value on bit %d.\n",
+								log_id(cell_name), log_id(conn_name), bitval_node->data_string.c_str(), i);
+				} else
+				if (bitval_node->type == 'N') {
+					int bitidx = bitval_node->data_number;
+					if (signal_bits.count(bitidx) == 0) {
+						Wire *placeholder = module->addWire(NEW_ID);
+						placeholders.insert(placeholder);
+						placeholder_wires.push_back(placeholder);
+						signal_bits[bitidx] = placeholder;
+					}
+					sig.append(signal_bits.at(bitidx));
+				} else
+					log_error("JSON cells node '%s' connection '%s' has invalid bit value on bit %d.\n",
+							log_id(cell_name), log_id(conn_name), i);
 
-				cell->setPort(conn_name, sig);
 			}
 
-			if (cell_node->data_dict.count("attributes"))
-				json_parse_attr_param(cell->attributes, cell_node->data_dict.at("attributes"));
-
-			if (cell_node->data_dict.count("parameters"))
-				json_parse_attr_param(cell->parameters, cell_node->data_dict.at("parameters"));
+			cell->setPort(conn_name, sig);
 		}
+
+		if (cell_node->data_dict.count("attributes"))
+			json_parse_attr_param(cell->attributes, cell_node->data_dict.at("attributes"));
+
+		if (cell_node->data_dict.count("parameters"))
+			json_parse_attr_param(cell->parameters, cell_node->data_dict.at("parameters"));
 	}
 
-	if (node->data_dict.count("memories"))
+	void import_memories(JsonNode *memories_node)
 	{
-		JsonNode *memories_node = node->data_dict.at("memories");
-
 		if (memories_node->type != 'D')
 			log_error("JSON memories node is not a dictionary.\n");
 
@@ -614,9 +681,120 @@ void json_import(Design *design, string &modname, JsonNode *node)
 		}
 	}
 
-	// remove duplicates from connections array
-	pool<RTLIL::SigSig> unique_connections(module->connections_.begin(), module->connections_.end());
-	module->connections_ = std::vector<RTLIL::SigSig>(unique_connections.begin(), unique_connections.end());
+	void finish()
+	{
+		for (auto cell : module->cells()) {
+			dict<IdString, SigSpec> new_connections;
+			for (auto &conn : cell->connections()) {
+				SigSpec sig = conn.second;
+				sig.replace(placeholder_map);
+				if (sig != conn.second)
+					new_connections[conn.first] = sig;
+			}
+			for (auto &it : new_connections)
+				cell->setPort(it.first, it.second);
+		}
+
+		pool<Wire*> replaced;
+		for (auto &it : placeholder_map)
+			replaced.insert(it.first.wire);
+		module->remove(replaced);
+
+		// Reinserts the wires and cells in the order in which a whole parsed tree
+		// was imported (netnames before cells, dict entries in reverse order), so
+		// that write_json reproduces a file written by write_json.
+		std::vector<Wire*> wires = port_wires;
+		wires.insert(wires.end(), netname_wires.rbegin(), netname_wires.rend());
+		for (auto wire : placeholder_wires)
+			if (placeholders.count(wire))
+				wires.push_back(wire);
+		log_assert(GetSize(wires) == GetSize(module->wires_));
+		module->wires_.clear();
+		for (auto wire : wires)
+			module->wires_[wire->name] = wire;
+
+		std::vector<Cell*> cells(module->cells().begin(), module->cells().end());
+		module->cells_.clear();
+		for (auto cell : cells)
+			module->cells_[cell->name] = cell;
+
+		// remove duplicates from connections array
+		pool<RTLIL::SigSig> unique_connections(module->connections_.begin(), module->connections_.end());
+		module->connections_ = std::vector<RTLIL::SigSig>(unique_connections.begin(), unique_connections.end());
+	}
+};
+
+// Parses a dict from the stream and calls `func` with each key, with the
+// stream at the start of the value, which `func` must parse.
+static void json_parse_dict(JsonStream &f, const char *what, const std::function<void(const string&)> &func)
+{
+	if (f.peek(" \t\r\n") != '{')
+		log_error("JSON %s node is not a dictionary.\n", what);
+	f.get();
+
+	while (1)
+	{
+		int ch = f.peek(" \t\r\n,");
+
+		if (ch == EOF)
+			log_error("Unexpected EOF in JSON file.\n");
+
+		if (ch == '}') {
+			f.get();
+			break;
+		}
+
+		JsonNode key(f);
+
+		if (key.type != 'S')
+			log_error("Unexpected non-string key in JSON dict.\n");
+
+		f.peek(" \t\r\n:");
+		func(key.data_string);
+	}
+}
+
+void json_import(Design *design, const string &modname, JsonStream &f)
+{
+	log("Importing module %s from JSON tree.\n", modname.c_str());
+
+	Module *module = new RTLIL::Module;
+	module->name = RTLIL::escape_id(modname.c_str());
+
+	if (design->module(module->name))
+		log_error("Re-definition of module %s.\n", log_id(module->name));
+
+	design->add(module);
+
+	JsonModuleImporter importer(module);
+
+	json_parse_dict(f, "module", [&](const string &key) {
+		if (key == "netnames") {
+			json_parse_dict(f, "netnames", [&](const string &name) {
+				JsonNode net_node(f);
+				importer.import_netname(RTLIL::escape_id(name.c_str()), &net_node);
+			});
+			return;
+		}
+
+		if (key == "cells") {
+			json_parse_dict(f, "cells", [&](const string &name) {
+				JsonNode cell_node(f);
+				importer.import_cell(RTLIL::escape_id(name.c_str()), &cell_node);
+			});
+			return;
+		}
+
+		JsonNode node(f);
+		if (key == "attributes")
+			json_parse_attr_param(module->attributes, &node);
+		else if (key == "ports")
+			importer.import_ports(&node);
+		else if (key == "memories")
+			importer.import_memories(&node);
+	});
+
+	importer.finish();
 }
 
 struct JsonFrontend : public Frontend {
@@ -630,6 +808,10 @@ struct JsonFrontend : public Frontend {
 		log("Load modules from a JSON file into the current design See \"help write_json\"\n");
 		log("for a description of the file format.\n");
 		log("\n");
+		log("The nets and cells are imported one at a time, as soon as each one is parsed,\n");
+		log("so only the parse tree of one net or cell is held in memory, also for a large\n");
+		log("flattened module.\n");
+		log("\n");
 	}
 	void execute(std::istream *&f, std::string filename, std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -646,21 +828,19 @@ struct JsonFrontend : public Frontend {
 		}
 		extra_args(f, filename, args, argidx);
 
-		JsonNode root(*f);
-
-		if (root.type != 'D')
-			log_error("JSON root node is not a dictionary.\n");
-
-		if (root.data_dict.count("modules") != 0)
-		{
-			JsonNode *modules = root.data_dict.at("modules");
-
-			if (modules->type != 'D')
-				log_error("JSON modules node is not a dictionary.\n");
+		// The modules are imported as they are parsed, see json_import()
+		JsonInput input(f, filename);
+		JsonStream stream(input);
 
-			for (auto &it : modules->data_dict)
-				json_import(design, it.first, it.second);
-		}
+		json_parse_dict(stream, "root", [&](const string &key) {
+			if (key != "modules") {
+				JsonNode value(stream);
+				return;
+			}
+			json_parse_dict(stream, "modules", [&](const string &modname) {
+				json_import(design, modname, stream);
+			});
+		});
 	}
 } JsonFrontend;
 
@@ -436,7 +436,9 @@ struct LibertyFrontend : public Frontend {
 		log("\n");
 		log("    read_liberty [filename]\n");
 		log("\n");
-		log("Read cells from liberty file as modules into current design.\n");
+		log("Read cells from liberty file as modules into current design. The parsed file\n");
+		log("is cached in the directory given by the scratchpad variable liberty.cache, if\n");
+		log("set, and loaded from there when the file is read again.\n");
 		log("\n");
 		log("    -lib\n");
 		log("        only create empty blackbox modules\n");
@@ -539,7 +541,7 @@ struct LibertyFrontend : public Frontend {
 
 		log_header(design, "Executing Liberty frontend: %s\n", filename.c_str());
 
-		LibertyParser parser(*f);
+		LibertyParser parser(*f, filename);
 		int cell_count = 0;
 
 		std::map<std::string, std::tuple<int, int, bool>> global_type_map;
@@ -0,0 +1,457 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ *  ---
+ *
+ *  Reader for the binary encoding of the RTLIL representation, as written
+ *  by write_rtlil -binary.
+ *
+ */
+
+#include "rtlil_frontend.h"
+#include "backends/rtlil/rtlil_backend.h"
+
+#if !defined(_WIN32)
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+using namespace RTLIL_FRONTEND;
+
+namespace {
+
+// The contents of the file, mapped into memory when it is a plain file.
+struct BinaryInput
+{
+	std::string buffer;
+	const char *data = nullptr;
+	size_t size = 0;
+	void *mapped = nullptr;
+
+	BinaryInput(std::istream *f, const std::string &filename)
+	{
+#if !defined(_WIN32)
+		if (dynamic_cast<std::ifstream*>(f) != nullptr) {
+			int fd = open(filename.c_str(), O_RDONLY);
+			struct stat st;
+			if (fd >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+				void *ptr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (ptr != MAP_FAILED) {
+					mapped = ptr;
+					data = static_cast<const char*>(ptr);
+					size = st.st_size;
+				}
+			}
+			if (fd >= 0)
+				close(fd);
+			if (mapped != nullptr)
+				return;
+		}
+#endif
+		std::stringstream ss;
+		ss << f->rdbuf();
+		buffer = ss.str();
+		data = buffer.data();
+		size = buffer.size();
+	}
+
+	~BinaryInput()
+	{
+#if !defined(_WIN32)
+		if (mapped != nullptr)
+			munmap(mapped, size);
+#endif
+	}
+};
+
+struct BinaryReader
+{
+	RTLIL::Design *design;
+	const char *data;
+	size_t size;
+	const char *ptr = nullptr, *end = nullptr;
+
+	std::vector<std::pair<size_t, size_t>> strings;
+	std::vector<RTLIL::IdString> ids;
+	std::vector<bool> ids_valid;
+
+	BinaryReader(RTLIL::Design *design, const char *data, size_t size) : design(design), data(data), size(size) { }
+
+	[[noreturn]] void invalid(const char *what)
+	{
+		log_error("Invalid binary RTLIL file: %s.\n", what);
+	}
+
+	void seek(size_t offset, size_t length)
+	{
+		if (offset > size || length > size - offset)
+			invalid("offset out of range");
+		ptr = data + offset;
+		end = ptr + length;
+	}
+
+	uint64_t get_uint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (ptr == end)
+				invalid("unexpected end of data");
+			uint8_t byte = *ptr++;
+			value |= uint64_t(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0)
+				return value;
+		}
+		invalid("integer too long");
+	}
+
+	int get_int32()
+	{
+		uint64_t value = get_uint();
+		if (value > uint64_t(std::numeric_limits<int>::max()))
+			invalid("integer out of range");
+		return value;
+	}
+
+	int get_sint32()
+	{
+		uint64_t value = get_uint();
+		int64_t decoded = int64_t(value >> 1) ^ -int64_t(value & 1);
+		if (decoded < std::numeric_limits<int>::min() || decoded > std::numeric_limits<int>::max())
+			invalid("integer out of range");
+		return decoded;
+	}
+
+	uint8_t get_byte()
+	{
+		if (ptr == end)
+			invalid("unexpected end of data");
+		return *ptr++;
+	}
+
+	size_t get_index(size_t count)
+	{
+		uint64_t idx = get_uint();
+		if (idx >= count)
+			invalid("index out of range");
+		return idx;
+	}
+
+	std::string get_string()
+	{
+		auto &entry = strings[get_index(strings.size())];
+		return std::string(data + entry.first, entry.second);
+	}
+
+	RTLIL::IdString get_id()
+	{
+		size_t idx = get_index(strings.size());
+		if (!ids_valid[idx]) {
+			auto &entry = strings[idx];
+			ids[idx] = RTLIL::IdString(std::string(data + entry.first, entry.second));
+			ids_valid[idx] = true;
+		}
+		return ids[idx];
+	}
+
+	std::vector<RTLIL::State> get_bits()
+	{
+		int width = get_int32();
+		uint8_t kind = get_byte();
+		std::vector<RTLIL::State> bits(width);
+		if (kind == 0) {
+			if (size_t(end - ptr) < size_t(width + 7) / 8)
+				invalid("unexpected end of data");
+			for (int i = 0; i < width; i += 8) {
+				uint8_t byte = *ptr++;
+				for (int j = 0; j < 8 && i+j < width; j++)
+					bits[i+j] = (byte >> j) & 1 ? State::S1 : State::S0;
+			}
+		} else if (kind == 1) {
+			if (size_t(end - ptr) < size_t(width))
+				invalid("unexpected end of data");
+			for (int i = 0; i < width; i++) {
+				uint8_t state = *ptr++;
+				if (state > RTLIL::Sm)
+					invalid("unknown bit state");
+				bits[i] = RTLIL::State(state);
+			}
+		} else
+			invalid("unknown constant encoding");
+		return bits;
+	}
+
+	RTLIL::Const get_const()
+	{
+		int flags = get_int32();
+		RTLIL::Const value;
+		if (flags & RTLIL::CONST_FLAG_STRING)
+			value = RTLIL::Const(get_string());
+		else
+			value = RTLIL::Const(get_bits());
+		value.flags = flags;
+		return value;
+	}
+
+	// The entries were written in the iteration order of the dict, which is the
+	// reverse of their insertion order
+	dict<RTLIL::IdString, RTLIL::Const> get_const_dict()
+	{
+		std::vector<std::pair<RTLIL::IdString, RTLIL::Const>> entries;
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::IdString name = get_id();
+			entries.emplace_back(name, get_const());
+		}
+		dict<RTLIL::IdString, RTLIL::Const> values;
+		for (auto it = entries.rbegin(); it != entries.rend(); ++it)
+			values[it->first] = std::move(it->second);
+		return values;
+	}
+
+	RTLIL::SigSpec get_sigspec(const std::vector<RTLIL::Wire*> &wires)
+	{
+		RTLIL::SigSpec sig;
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			uint64_t tag = get_uint();
+			if (tag == 0) {
+				sig.append(RTLIL::Const(get_bits()));
+				continue;
+			}
+			if ((tag >> 1) - 1 >= wires.size())
+				invalid("wire index out of range");
+			RTLIL::Wire *wire = wires[(tag >> 1) - 1];
+			if (tag & 1) {
+				sig.append(wire);
+				continue;
+			}
+			int offset = get_int32();
+			int width = get_int32();
+			if (offset > wire->width || width > wire->width - offset)
+				invalid("wire slice out of range");
+			sig.append(RTLIL::SigSpec(wire, offset, width));
+		}
+		return sig;
+	}
+
+	void get_case(RTLIL::CaseRule *cs, const std::vector<RTLIL::Wire*> &wires)
+	{
+		cs->attributes = get_const_dict();
+		for (uint64_t i = 0, n = get_uint(); i < n; i++)
+			cs->compare.push_back(get_sigspec(wires));
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::SigSpec lhs = get_sigspec(wires);
+			cs->actions.push_back(RTLIL::SigSig(lhs, get_sigspec(wires)));
+		}
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::SwitchRule *sw = new RTLIL::SwitchRule;
+			cs->switches.push_back(sw);
+			sw->attributes = get_const_dict();
+			sw->signal = get_sigspec(wires);
+			for (uint64_t j = 0, m = get_uint(); j < m; j++) {
+				RTLIL::CaseRule *child = new RTLIL::CaseRule;
+				sw->cases.push_back(child);
+				get_case(child, wires);
+			}
+		}
+	}
+
+	void get_module_body(RTLIL::Module *module)
+	{
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::IdString name = get_id();
+			module->avail_parameters(name);
+			if (get_byte())
+				module->parameter_default_values[name] = get_const();
+		}
+
+		std::vector<RTLIL::Wire*> wires;
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::IdString name = get_id();
+			if (module->wire(name) != nullptr)
+				log_error("RTLIL error: redefinition of wire %s.\n", log_id(name));
+			RTLIL::Wire *wire = module->addWire(name, get_int32());
+			wire->start_offset = get_sint32();
+			wire->port_id = get_int32();
+			uint8_t flags = get_byte();
+			wire->port_input = flags & 1;
+			wire->port_output = flags & 2;
+			wire->upto = flags & 4;
+			wire->is_signed = flags & 8;
+			wire->attributes = get_const_dict();
+			wires.push_back(wire);
+		}
+
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::IdString name = get_id();
+			if (module->memories.count(name) != 0)
+				log_error("RTLIL error: redefinition of memory %s.\n", log_id(name));
+			RTLIL::Memory *memory = new RTLIL::Memory;
+			memory->name = name;
+			module->memories[name] = memory;
+			memory->width = get_int32();
+			memory->start_offset = get_sint32();
+			memory->size = get_int32();
+			memory->attributes = get_const_dict();
+		}
+
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::IdString name = get_id();
+			if (module->cell(name) != nullptr)
+				log_error("RTLIL error: redefinition of cell %s.\n", log_id(name));
+			RTLIL::Cell *cell = module->addCell(name, get_id());
+			cell->attributes = get_const_dict();
+			cell->parameters = get_const_dict();
+			for (uint64_t j = 0, m = get_uint(); j < m; j++) {
+				RTLIL::IdString port = get_id();
+				cell->setPort(port, get_sigspec(wires));
+			}
+		}
+
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::IdString name = get_id();
+			if (module->processes.count(name) != 0)
+				log_error("RTLIL error: redefinition of process %s.\n", log_id(name));
+			RTLIL::Process *proc = module->addProcess(name);
+			proc->attributes = get_const_dict();
+			get_case(&proc->root_case, wires);
+			for (uint64_t j = 0, m = get_uint(); j < m; j++) {
+				RTLIL::SyncRule *sync = new RTLIL::SyncRule;
+				proc->syncs.push_back(sync);
+				uint8_t type = get_byte();
+				if (type > RTLIL::STi)
+					invalid("unknown sync type");
+				sync->type = RTLIL::SyncType(type);
+				sync->signal = get_sigspec(wires);
+				for (uint64_t k = 0, l = get_uint(); k < l; k++) {
+					RTLIL::SigSpec lhs = get_sigspec(wires);
+					sync->actions.push_back(RTLIL::SigSig(lhs, get_sigspec(wires)));
+				}
+				for (uint64_t k = 0, l = get_uint(); k < l; k++) {
+					RTLIL::MemWriteAction act;
+					act.attributes = get_const_dict();
+					act.memid = get_id();
+					act.address = get_sigspec(wires);
+					act.data = get_sigspec(wires);
+					act.enable = get_sigspec(wires);
+					act.priority_mask = get_const();
+					sync->mem_write_actions.push_back(std::move(act));
+				}
+			}
+		}
+
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			RTLIL::SigSpec lhs = get_sigspec(wires);
+			module->connect(lhs, get_sigspec(wires));
+		}
+
+		if (ptr != end)
+			invalid("trailing data in module section");
+	}
+
+	void get_module(size_t offset, size_t length)
+	{
+		seek(offset, length);
+		RTLIL::IdString name = get_id();
+		dict<RTLIL::IdString, RTLIL::Const> attributes = get_const_dict();
+
+		// Same rules as for the text format, but the sections of the ignored
+		// modules are not decoded at all.
+		if (design->has(name)) {
+			RTLIL::Module *existing_mod = design->module(name);
+			if (!flag_overwrite && (flag_lib || (attributes.count(ID::blackbox) && attributes.at(ID::blackbox).as_bool()))) {
+				log("Ignoring blackbox re-definition of module %s.\n", log_id(name));
+				return;
+			} else if (!flag_nooverwrite && !flag_overwrite && !existing_mod->get_bool_attribute(ID::blackbox)) {
+				log_error("RTLIL error: redefinition of module %s.\n", log_id(name));
+			} else if (flag_nooverwrite) {
+				log("Ignoring re-definition of module %s.\n", log_id(name));
+				return;
+			} else {
+				log("Replacing existing%s module %s.\n", existing_mod->get_bool_attribute(ID::blackbox) ? " blackbox" : "", log_id(name));
+				design->remove(existing_mod);
+			}
+		}
+
+		RTLIL::Module *module = new RTLIL::Module;
+		module->name = name;
+		module->attributes = std::move(attributes);
+		design->add(module);
+		get_module_body(module);
+		module->fixup_ports();
+		if (flag_lib)
+			module->makeblackbox();
+	}
+
+	void read()
+	{
+		if (size < 16 || memcmp(data, RTLIL_BACKEND::binary_magic, sizeof(RTLIL_BACKEND::binary_magic)) != 0)
+			invalid("bad header");
+
+		size_t table_offset = 0;
+		for (int i = 0; i < 8; i++)
+			table_offset |= size_t(uint8_t(data[size-8+i])) << (8*i);
+		seek(table_offset, size - 8 - std::min(table_offset, size - 8));
+
+		size_t count = get_uint();
+		if (count > size_t(end - ptr))
+			invalid("string table too large");
+		strings.reserve(count);
+		for (size_t i = 0; i < count; i++) {
+			size_t length = get_uint();
+			if (length > size_t(end - ptr))
+				invalid("unexpected end of data");
+			strings.push_back({size_t(ptr - data), length});
+			ptr += length;
+		}
+		ids.resize(count);
+		ids_valid.resize(count);
+
+		size_t index_offset = get_uint();
+		seek(index_offset, table_offset - std::min(index_offset, table_offset));
+		autoidx = max(autoidx, get_int32());
+
+		std::vector<std::pair<size_t, size_t>> sections;
+		for (uint64_t i = 0, n = get_uint(); i < n; i++) {
+			get_index(strings.size());
+			size_t offset = get_uint();
+			size_t length = get_uint();
+			sections.push_back({offset, length});
+		}
+
+		for (auto &it : sections)
+			get_module(it.first, it.second);
+	}
+};
+
+}
+
+bool RTLIL_FRONTEND::is_binary(std::istream *f)
+{
+	return f->peek() == RTLIL_BACKEND::binary_magic[0];
+}
+
+void RTLIL_FRONTEND::read_binary(std::istream *f, const std::string &filename, RTLIL::Design *design)
+{
+	BinaryInput input(f, filename);
+	BinaryReader reader(design, input.data, input.size);
+	reader.read();
+}
+
+YOSYS_NAMESPACE_END
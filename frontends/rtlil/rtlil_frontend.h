@@ -35,6 +35,10 @@ namespace RTLIL_FRONTEND {
 	extern bool flag_nooverwrite;
 	extern bool flag_overwrite;
 	extern bool flag_lib;
+
+	// Reader for the files of write_rtlil -binary, with the flags above
+	bool is_binary(std::istream *f);
+	void read_binary(std::istream *f, const std::string &filename, RTLIL::Design *design);
 }
 
 YOSYS_NAMESPACE_END
@@ -97,6 +97,149 @@ static RTLIL::Const big2const(const BigInteger &val, int result_len, int undef_b
 	return result;
 }
 
+// Two-plane packed representation of a constant, used by the word-parallel bitwise kernels
+// below. Bit i of `val` is set if bit i is S1, and bit i of `undef` is set if bit i is neither
+// S0 nor S1 (in which case the `val` bit is clear). Bits beyond `width` are clear in both
+// planes. Constants of up to 256 bits are packed without any heap allocation.
+struct PackedConst
+{
+	static constexpr int inline_words = 4;
+
+	int width, words;
+	uint64_t *val, *undef;
+	uint64_t inline_storage[2 * inline_words];
+	std::vector<uint64_t> heap_storage;
+
+	PackedConst(int width) : width(width), words((width + 63) / 64)
+	{
+		if (words <= inline_words) {
+			val = inline_storage;
+		} else {
+			heap_storage.resize(2 * words);
+			val = heap_storage.data();
+		}
+		undef = val + words;
+		std::fill(val, val + 2 * words, 0);
+	}
+
+	PackedConst(const PackedConst&) = delete;
+	PackedConst &operator=(const PackedConst&) = delete;
+
+	// Packs `arg` zero- or sign-extended (or truncated) to `width` bits, like extend_u0().
+	PackedConst(const RTLIL::Const &arg, int width, bool is_signed) : PackedConst(width)
+	{
+		int i = 0;
+		for (auto bit : arg) {
+			if (i == width)
+				break;
+			set(i++, bit);
+		}
+		if (i < width && i > 0 && is_signed)
+			for (RTLIL::State padding = arg.back(); i < width; i++)
+				set(i, padding);
+	}
+
+	void set(int i, RTLIL::State bit)
+	{
+		if (bit == RTLIL::State::S1)
+			val[i / 64] |= uint64_t(1) << (i % 64);
+		else if (bit != RTLIL::State::S0)
+			undef[i / 64] |= uint64_t(1) << (i % 64);
+	}
+
+	uint64_t mask(int word) const
+	{
+		int rem = width - 64 * word;
+		return rem >= 64 ? ~uint64_t(0) : (uint64_t(1) << rem) - 1;
+	}
+
+	// Returns the constant, with all undefined bits as Sx.
+	RTLIL::Const unpack() const
+	{
+		std::vector<RTLIL::State> bits(width);
+		for (int i = 0; i < width; i++) {
+			uint64_t bit = uint64_t(1) << (i % 64);
+			bits[i] = (undef[i / 64] & bit) ? RTLIL::State::Sx : (val[i / 64] & bit) ? RTLIL::State::S1 : RTLIL::State::S0;
+		}
+		return RTLIL::Const(std::move(bits));
+	}
+};
+
+// Word kernels for the bitwise operators. The input `val` words must be clear where `undef` is set.
+static void packed_and(uint64_t a, uint64_t a_undef, uint64_t b, uint64_t b_undef, uint64_t &y, uint64_t &y_undef)
+{
+	uint64_t zero = (~a & ~a_undef) | (~b & ~b_undef);
+	y = a & b;
+	y_undef = ~(y | zero);
+}
+
+static void packed_or(uint64_t a, uint64_t a_undef, uint64_t b, uint64_t b_undef, uint64_t &y, uint64_t &y_undef)
+{
+	uint64_t zero = (~a & ~a_undef) & (~b & ~b_undef);
+	y = a | b;
+	y_undef = ~(y | zero);
+}
+
+static void packed_xor(uint64_t a, uint64_t a_undef, uint64_t b, uint64_t b_undef, uint64_t &y, uint64_t &y_undef)
+{
+	y_undef = a_undef | b_undef;
+	y = (a ^ b) & ~y_undef;
+}
+
+static void packed_xnor(uint64_t a, uint64_t a_undef, uint64_t b, uint64_t b_undef, uint64_t &y, uint64_t &y_undef)
+{
+	y_undef = a_undef | b_undef;
+	y = ~(a ^ b) & ~y_undef;
+}
+
+// Reduction of all the bits of `arg` with logic_or: S1 if any bit is S1, Sx otherwise if any bit is undefined, S0 otherwise.
+// This is also the truth value of `arg` as used by the logic operators. A single scan needs no packing.
+static RTLIL::State const_reduce_or_bit(const RTLIL::Const &arg)
+{
+	bool undef = false;
+	for (auto bit : arg) {
+		if (bit == RTLIL::State::S1)
+			return RTLIL::State::S1;
+		if (bit != RTLIL::State::S0)
+			undef = true;
+	}
+	return undef ? RTLIL::State::Sx : RTLIL::State::S0;
+}
+
+// Fast path for const2big(): converts `val` to an int64_t if it is fully defined and at most `max_width` bits wide.
+// With max_width <= 62, sums and differences of two such values cannot overflow, and with max_width <= 31, neither
+// can their products.
+static bool const2int64(const RTLIL::Const &val, bool as_signed, int max_width, int64_t &result)
+{
+	int width = GetSize(val);
+	if (width > max_width)
+		return false;
+
+	uint64_t mag = 0;
+	int i = 0;
+	for (auto bit : val) {
+		if (bit == RTLIL::State::S1)
+			mag |= uint64_t(1) << i;
+		else if (bit != RTLIL::State::S0)
+			return false;
+		i++;
+	}
+
+	if (as_signed && width > 0 && (mag >> (width - 1)) & 1)
+		mag |= ~uint64_t(0) << width;
+	result = int64_t(mag);
+	return true;
+}
+
+// Counterpart of big2const() for const2int64() results: the two's complement of `val`, truncated or sign-extended to `result_len` bits.
+static RTLIL::Const int642const(int64_t val, int result_len)
+{
+	std::vector<RTLIL::State> bits(result_len);
+	for (int i = 0; i < result_len; i++)
+		bits[i] = ((i < 64 ? uint64_t(val) >> i : uint64_t(val) >> 63) & 1) ? RTLIL::State::S1 : RTLIL::State::S0;
+	return RTLIL::Const(std::move(bits));
+}
+
 static RTLIL::State logic_and(RTLIL::State a, RTLIL::State b)
 {
 	if (a == RTLIL::State::S0) return RTLIL::State::S0;
@@ -115,88 +258,60 @@ static RTLIL::State logic_or(RTLIL::State a, RTLIL::State b)
 	return RTLIL::State::S0;
 }
 
-static RTLIL::State logic_xor(RTLIL::State a, RTLIL::State b)
-{
-	if (a != RTLIL::State::S0 && a != RTLIL::State::S1) return RTLIL::State::Sx;
-	if (b != RTLIL::State::S0 && b != RTLIL::State::S1) return RTLIL::State::Sx;
-	return a != b ? RTLIL::State::S1 : RTLIL::State::S0;
-}
-
-static RTLIL::State logic_xnor(RTLIL::State a, RTLIL::State b)
-{
-	if (a != RTLIL::State::S0 && a != RTLIL::State::S1) return RTLIL::State::Sx;
-	if (b != RTLIL::State::S0 && b != RTLIL::State::S1) return RTLIL::State::Sx;
-	return a == b ? RTLIL::State::S1 : RTLIL::State::S0;
-}
-
 RTLIL::Const RTLIL::const_not(const RTLIL::Const &arg1, const RTLIL::Const&, bool signed1, bool, int result_len)
 {
 	if (result_len < 0)
 		result_len = GetSize(arg1);
 
-	RTLIL::Const arg1_ext = arg1;
-	extend_u0(arg1_ext, result_len, signed1);
-
-	RTLIL::Const result(RTLIL::State::Sx, result_len);
-	for (auto i = 0; i < result_len; i++) {
-		if (i >= GetSize(arg1_ext))
-			result.bits()[i] = RTLIL::State::S0;
-		else if (arg1_ext.bits()[i] == RTLIL::State::S0)
-			result.bits()[i] = RTLIL::State::S1;
-		else if (arg1_ext.bits()[i] == RTLIL::State::S1)
-			result.bits()[i] = RTLIL::State::S0;
-	}
+	PackedConst result(arg1, result_len, signed1);
+	for (int i = 0; i < result.words; i++)
+		result.val[i] = ~result.val[i] & ~result.undef[i] & result.mask(i);
 
-	return result;
+	return result.unpack();
 }
 
-static RTLIL::Const logic_wrapper(RTLIL::State(*logic_func)(RTLIL::State, RTLIL::State),
-		RTLIL::Const arg1, RTLIL::Const arg2, bool signed1, bool signed2, int result_len = -1)
+static RTLIL::Const logic_wrapper(void(*packed_func)(uint64_t, uint64_t, uint64_t, uint64_t, uint64_t&, uint64_t&),
+		const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len = -1)
 {
 	if (result_len < 0)
 		result_len = max(GetSize(arg1), GetSize(arg2));
 
-	extend_u0(arg1, result_len, signed1);
-	extend_u0(arg2, result_len, signed2);
+	PackedConst a(arg1, result_len, signed1);
+	PackedConst b(arg2, result_len, signed2);
 
-	RTLIL::Const result(RTLIL::State::Sx, result_len);
-	for (auto i = 0; i < result_len; i++) {
-		RTLIL::State a = i < GetSize(arg1) ? arg1.bits()[i] : RTLIL::State::S0;
-		RTLIL::State b = i < GetSize(arg2) ? arg2.bits()[i] : RTLIL::State::S0;
-		result.bits()[i] = logic_func(a, b);
+	PackedConst result(result_len);
+	for (int i = 0; i < result.words; i++) {
+		packed_func(a.val[i], a.undef[i], b.val[i], b.undef[i], result.val[i], result.undef[i]);
+		result.undef[i] &= result.mask(i);
+		result.val[i] &= result.mask(i) & ~result.undef[i];
 	}
 
-	return result;
+	return result.unpack();
 }
 
 RTLIL::Const RTLIL::const_and(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_and, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(packed_and, arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::Const RTLIL::const_or(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_or, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(packed_or, arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::Const RTLIL::const_xor(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_xor, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(packed_xor, arg1, arg2, signed1, signed2, result_len);
 }
 
 RTLIL::Const RTLIL::const_xnor(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	return logic_wrapper(logic_xnor, arg1, arg2, signed1, signed2, result_len);
+	return logic_wrapper(packed_xnor, arg1, arg2, signed1, signed2, result_len);
 }
 
-static RTLIL::Const logic_reduce_wrapper(RTLIL::State initial, RTLIL::State(*logic_func)(RTLIL::State, RTLIL::State), const RTLIL::Const &arg1, int result_len)
+static RTLIL::Const logic_reduce_wrapper(RTLIL::State y, int result_len)
 {
-	RTLIL::State temp = initial;
-
-	for (auto i = 0; i < arg1.size(); i++)
-		temp = logic_func(temp, arg1[i]);
-
-	RTLIL::Const result(temp);
+	RTLIL::Const result(y);
 	while (GetSize(result) < result_len)
 		result.bits().push_back(RTLIL::State::S0);
 	return result;
@@ -204,22 +319,36 @@ static RTLIL::Const logic_reduce_wrapper(RTLIL::State initial, RTLIL::State(*log
 
 RTLIL::Const RTLIL::const_reduce_and(const RTLIL::Const &arg1, const RTLIL::Const&, bool, bool, int result_len)
 {
-	return logic_reduce_wrapper(RTLIL::State::S1, logic_and, arg1, result_len);
+	bool undef = false;
+	for (auto bit : arg1) {
+		if (bit == RTLIL::State::S0)
+			return logic_reduce_wrapper(RTLIL::State::S0, result_len);
+		if (bit != RTLIL::State::S1)
+			undef = true;
+	}
+	return logic_reduce_wrapper(undef ? RTLIL::State::Sx : RTLIL::State::S1, result_len);
 }
 
 RTLIL::Const RTLIL::const_reduce_or(const RTLIL::Const &arg1, const RTLIL::Const&, bool, bool, int result_len)
 {
-	return logic_reduce_wrapper(RTLIL::State::S0, logic_or, arg1, result_len);
+	return logic_reduce_wrapper(const_reduce_or_bit(arg1), result_len);
 }
 
 RTLIL::Const RTLIL::const_reduce_xor(const RTLIL::Const &arg1, const RTLIL::Const&, bool, bool, int result_len)
 {
-	return logic_reduce_wrapper(RTLIL::State::S0, logic_xor, arg1, result_len);
+	bool parity = false;
+	for (auto bit : arg1) {
+		if (bit == RTLIL::State::S1)
+			parity = !parity;
+		else if (bit != RTLIL::State::S0)
+			return logic_reduce_wrapper(RTLIL::State::Sx, result_len);
+	}
+	return logic_reduce_wrapper(parity ? RTLIL::State::S1 : RTLIL::State::S0, result_len);
 }
 
 RTLIL::Const RTLIL::const_reduce_xnor(const RTLIL::Const &arg1, const RTLIL::Const&, bool, bool, int result_len)
 {
-	RTLIL::Const buffer = logic_reduce_wrapper(RTLIL::State::S0, logic_xor, arg1, result_len);
+	RTLIL::Const buffer = RTLIL::const_reduce_xor(arg1, RTLIL::Const(), false, false, result_len);
 	if (!buffer.empty()) {
 		if (buffer.front() == RTLIL::State::S0)
 			buffer.bits().front() = RTLIL::State::S1;
@@ -231,28 +360,23 @@ RTLIL::Const RTLIL::const_reduce_xnor(const RTLIL::Const &arg1, const RTLIL::Con
 
 RTLIL::Const RTLIL::const_reduce_bool(const RTLIL::Const &arg1, const RTLIL::Const&, bool, bool, int result_len)
 {
-	return logic_reduce_wrapper(RTLIL::State::S0, logic_or, arg1, result_len);
+	return logic_reduce_wrapper(const_reduce_or_bit(arg1), result_len);
 }
 
-RTLIL::Const RTLIL::const_logic_not(const RTLIL::Const &arg1, const RTLIL::Const&, bool signed1, bool, int result_len)
+RTLIL::Const RTLIL::const_logic_not(const RTLIL::Const &arg1, const RTLIL::Const&, bool, bool, int result_len)
 {
-	int undef_bit_pos_a = -1;
-	BigInteger a = const2big(arg1, signed1, undef_bit_pos_a);
-	RTLIL::Const result(a.isZero() ? undef_bit_pos_a >= 0 ? RTLIL::State::Sx : RTLIL::State::S1 : RTLIL::State::S0);
+	RTLIL::State bit_a = const_reduce_or_bit(arg1);
+	RTLIL::Const result(bit_a == RTLIL::State::S0 ? RTLIL::State::S1 : bit_a == RTLIL::State::S1 ? RTLIL::State::S0 : RTLIL::State::Sx);
 
 	while (GetSize(result) < result_len)
 		result.bits().push_back(RTLIL::State::S0);
 	return result;
 }
 
-RTLIL::Const RTLIL::const_logic_and(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
+RTLIL::Const RTLIL::const_logic_and(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool, bool, int result_len)
 {
-	int undef_bit_pos_a = -1, undef_bit_pos_b = -1;
-	BigInteger a = const2big(arg1, signed1, undef_bit_pos_a);
-	BigInteger b = const2big(arg2, signed2, undef_bit_pos_b);
-
-	RTLIL::State bit_a = a.isZero() ? undef_bit_pos_a >= 0 ? RTLIL::State::Sx : RTLIL::State::S0 : RTLIL::State::S1;
-	RTLIL::State bit_b = b.isZero() ? undef_bit_pos_b >= 0 ? RTLIL::State::Sx : RTLIL::State::S0 : RTLIL::State::S1;
+	RTLIL::State bit_a = const_reduce_or_bit(arg1);
+	RTLIL::State bit_b = const_reduce_or_bit(arg2);
 	RTLIL::Const result(logic_and(bit_a, bit_b));
 
 	while (GetSize(result) < result_len)
@@ -260,14 +384,10 @@ RTLIL::Const RTLIL::const_logic_and(const RTLIL::Const &arg1, const RTLIL::Const
 	return result;
 }
 
-RTLIL::Const RTLIL::const_logic_or(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
+RTLIL::Const RTLIL::const_logic_or(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool, bool, int result_len)
 {
-	int undef_bit_pos_a = -1, undef_bit_pos_b = -1;
-	BigInteger a = const2big(arg1, signed1, undef_bit_pos_a);
-	BigInteger b = const2big(arg2, signed2, undef_bit_pos_b);
-
-	RTLIL::State bit_a = a.isZero() ? undef_bit_pos_a >= 0 ? RTLIL::State::Sx : RTLIL::State::S0 : RTLIL::State::S1;
-	RTLIL::State bit_b = b.isZero() ? undef_bit_pos_b >= 0 ? RTLIL::State::Sx : RTLIL::State::S0 : RTLIL::State::S1;
+	RTLIL::State bit_a = const_reduce_or_bit(arg1);
+	RTLIL::State bit_b = const_reduce_or_bit(arg2);
 	RTLIL::Const result(logic_or(bit_a, bit_b));
 
 	while (GetSize(result) < result_len)
@@ -292,14 +412,20 @@ static RTLIL::Const const_shift_worker(const RTLIL::Const &arg1, const RTLIL::Co
 	if (undef_bit_pos >= 0)
 		return result;
 
+	// Offsets beyond the size of both operands all give the same result, so clamp the offset
+	// once instead of doing BigInteger arithmetic for each bit.
+	int limit = GetSize(arg1) + result_len;
+	int int_offset = offset > BigInteger(limit) ? limit : offset < BigInteger(-limit) ? -limit : offset.toInt();
+
+	std::vector<RTLIL::State> &bits = result.bits();
 	for (int i = 0; i < result_len; i++) {
-		BigInteger pos = BigInteger(i) + offset;
+		int pos = i + int_offset;
 		if (pos < 0)
-			result.bits()[i] = vacant_bits;
-		else if (pos >= BigInteger(GetSize(arg1)))
-			result.bits()[i] = sign_ext ? arg1.back() : vacant_bits;
+			bits[i] = vacant_bits;
+		else if (pos >= GetSize(arg1))
+			bits[i] = sign_ext ? arg1.back() : vacant_bits;
 		else
-			result.bits()[i] = arg1[pos.toInt()];
+			bits[i] = arg1[pos];
 	}
 
 	return result;
@@ -344,7 +470,12 @@ RTLIL::Const RTLIL::const_shiftx(const RTLIL::Const &arg1, const RTLIL::Const &a
 RTLIL::Const RTLIL::const_lt(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
 	int undef_bit_pos = -1;
-	bool y = const2big(arg1, signed1, undef_bit_pos) < const2big(arg2, signed2, undef_bit_pos);
+	int64_t a, b;
+	bool y;
+	if (const2int64(arg1, signed1, 62, a) && const2int64(arg2, signed2, 62, b))
+		y = a < b;
+	else
+		y = const2big(arg1, signed1, undef_bit_pos) < const2big(arg2, signed2, undef_bit_pos);
 	RTLIL::Const result(undef_bit_pos >= 0 ? RTLIL::State::Sx : y ? RTLIL::State::S1 : RTLIL::State::S0);
 
 	while (GetSize(result) < result_len)
@@ -355,7 +486,12 @@ RTLIL::Const RTLIL::const_lt(const RTLIL::Const &arg1, const RTLIL::Const &arg2,
 RTLIL::Const RTLIL::const_le(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
 	int undef_bit_pos = -1;
-	bool y = const2big(arg1, signed1, undef_bit_pos) <= const2big(arg2, signed2, undef_bit_pos);
+	int64_t a, b;
+	bool y;
+	if (const2int64(arg1, signed1, 62, a) && const2int64(arg2, signed2, 62, b))
+		y = a <= b;
+	else
+		y = const2big(arg1, signed1, undef_bit_pos) <= const2big(arg2, signed2, undef_bit_pos);
 	RTLIL::Const result(undef_bit_pos >= 0 ? RTLIL::State::Sx : y ? RTLIL::State::S1 : RTLIL::State::S0);
 
 	while (GetSize(result) < result_len)
@@ -365,21 +501,23 @@ RTLIL::Const RTLIL::const_le(const RTLIL::Const &arg1, const RTLIL::Const &arg2,
 
 RTLIL::Const RTLIL::const_eq(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
-	RTLIL::Const arg1_ext = arg1;
-	RTLIL::Const arg2_ext = arg2;
 	RTLIL::Const result(RTLIL::State::S0, result_len);
 
-	int width = max(GetSize(arg1_ext), GetSize(arg2_ext));
-	extend_u0(arg1_ext, width, signed1 && signed2);
-	extend_u0(arg2_ext, width, signed1 && signed2);
+	// Compares the operands bit by bit as if extended to the same width, without copying them
+	int width = max(GetSize(arg1), GetSize(arg2));
+	bool is_signed = signed1 && signed2;
+	RTLIL::State pad1 = is_signed && GetSize(arg1) > 0 ? arg1.back() : RTLIL::State::S0;
+	RTLIL::State pad2 = is_signed && GetSize(arg2) > 0 ? arg2.back() : RTLIL::State::S0;
 
 	RTLIL::State matched_status = RTLIL::State::S1;
-	for (auto i = 0; i < arg1_ext.size(); i++) {
-		if (arg1_ext.at(i) == RTLIL::State::S0 && arg2_ext.at(i) == RTLIL::State::S1)
+	for (int i = 0; i < width; i++) {
+		RTLIL::State a = i < GetSize(arg1) ? arg1[i] : pad1;
+		RTLIL::State b = i < GetSize(arg2) ? arg2[i] : pad2;
+		bool a_def = a == RTLIL::State::S0 || a == RTLIL::State::S1;
+		bool b_def = b == RTLIL::State::S0 || b == RTLIL::State::S1;
+		if (a_def && b_def && a != b)
 			return result;
-		if (arg1_ext.at(i) == RTLIL::State::S1 && arg2_ext.at(i) == RTLIL::State::S0)
-			return result;
-		if (arg1_ext.at(i) > RTLIL::State::S1 || arg2_ext.at(i) > RTLIL::State::S1)
+		if (!a_def || !b_def)
 			matched_status = RTLIL::State::Sx;
 	}
 
@@ -429,7 +567,12 @@ RTLIL::Const RTLIL::const_nex(const RTLIL::Const &arg1, const RTLIL::Const &arg2
 RTLIL::Const RTLIL::const_ge(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
 	int undef_bit_pos = -1;
-	bool y = const2big(arg1, signed1, undef_bit_pos) >= const2big(arg2, signed2, undef_bit_pos);
+	int64_t a, b;
+	bool y;
+	if (const2int64(arg1, signed1, 62, a) && const2int64(arg2, signed2, 62, b))
+		y = a >= b;
+	else
+		y = const2big(arg1, signed1, undef_bit_pos) >= const2big(arg2, signed2, undef_bit_pos);
 	RTLIL::Const result(undef_bit_pos >= 0 ? RTLIL::State::Sx : y ? RTLIL::State::S1 : RTLIL::State::S0);
 
 	while (GetSize(result) < result_len)
@@ -440,7 +583,12 @@ RTLIL::Const RTLIL::const_ge(const RTLIL::Const &arg1, const RTLIL::Const &arg2,
 RTLIL::Const RTLIL::const_gt(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
 	int undef_bit_pos = -1;
-	bool y = const2big(arg1, signed1, undef_bit_pos) > const2big(arg2, signed2, undef_bit_pos);
+	int64_t a, b;
+	bool y;
+	if (const2int64(arg1, signed1, 62, a) && const2int64(arg2, signed2, 62, b))
+		y = a > b;
+	else
+		y = const2big(arg1, signed1, undef_bit_pos) > const2big(arg2, signed2, undef_bit_pos);
 	RTLIL::Const result(undef_bit_pos >= 0 ? RTLIL::State::Sx : y ? RTLIL::State::S1 : RTLIL::State::S0);
 
 	while (GetSize(result) < result_len)
@@ -450,6 +598,10 @@ RTLIL::Const RTLIL::const_gt(const RTLIL::Const &arg1, const RTLIL::Const &arg2,
 
 RTLIL::Const RTLIL::const_add(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
+	int64_t a, b;
+	if (const2int64(arg1, signed1, 62, a) && const2int64(arg2, signed2, 62, b))
+		return int642const(a + b, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)));
+
 	int undef_bit_pos = -1;
 	BigInteger y = const2big(arg1, signed1, undef_bit_pos) + const2big(arg2, signed2, undef_bit_pos);
 	return big2const(y, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)), undef_bit_pos);
@@ -457,6 +609,10 @@ RTLIL::Const RTLIL::const_add(const RTLIL::Const &arg1, const RTLIL::Const &arg2
 
 RTLIL::Const RTLIL::const_sub(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
+	int64_t a, b;
+	if (const2int64(arg1, signed1, 62, a) && const2int64(arg2, signed2, 62, b))
+		return int642const(a - b, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)));
+
 	int undef_bit_pos = -1;
 	BigInteger y = const2big(arg1, signed1, undef_bit_pos) - const2big(arg2, signed2, undef_bit_pos);
 	return big2const(y, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)), undef_bit_pos);
@@ -464,6 +620,10 @@ RTLIL::Const RTLIL::const_sub(const RTLIL::Const &arg1, const RTLIL::Const &arg2
 
 RTLIL::Const RTLIL::const_mul(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
+	int64_t a, b;
+	if (const2int64(arg1, signed1, 31, a) && const2int64(arg2, signed2, 31, b))
+		return int642const(a * b, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)));
+
 	int undef_bit_pos = -1;
 	BigInteger y = const2big(arg1, signed1, undef_bit_pos) * const2big(arg2, signed2, undef_bit_pos);
 	return big2const(y, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)), min(undef_bit_pos, 0));
@@ -472,6 +632,11 @@ RTLIL::Const RTLIL::const_mul(const RTLIL::Const &arg1, const RTLIL::Const &arg2
 // truncating division
 RTLIL::Const RTLIL::const_div(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
+	// C++ integer division also truncates.
+	int64_t int_a, int_b;
+	if (const2int64(arg1, signed1, 62, int_a) && const2int64(arg2, signed2, 62, int_b) && int_b != 0)
+		return int642const(int_a / int_b, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)));
+
 	int undef_bit_pos = -1;
 	BigInteger a = const2big(arg1, signed1, undef_bit_pos);
 	BigInteger b = const2big(arg2, signed2, undef_bit_pos);
@@ -486,6 +651,11 @@ RTLIL::Const RTLIL::const_div(const RTLIL::Const &arg1, const RTLIL::Const &arg2
 // truncating modulo
 RTLIL::Const RTLIL::const_mod(const RTLIL::Const &arg1, const RTLIL::Const &arg2, bool signed1, bool signed2, int result_len)
 {
+	// C++ integer modulo also takes the sign of the dividend.
+	int64_t int_a, int_b;
+	if (const2int64(arg1, signed1, 62, int_a) && const2int64(arg2, signed2, 62, int_b) && int_b != 0)
+		return int642const(int_a % int_b, result_len >= 0 ? result_len : max(GetSize(arg1), GetSize(arg2)));
+
 	int undef_bit_pos = -1;
 	BigInteger a = const2big(arg1, signed1, undef_bit_pos);
 	BigInteger b = const2big(arg2, signed2, undef_bit_pos);
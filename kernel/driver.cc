@@ -199,6 +199,7 @@ int main(int argc, char **argv)
 	std::string depsfile = "";
 	std::string topmodule = "";
 	std::string perffile = "";
+	std::string profilefile = "";
 	bool scriptfile_tcl = false;
 	bool scriptfile_python = false;
 	bool print_banner = true;
@@ -237,6 +238,9 @@ int main(int argc, char **argv)
 			cxxopts::value<std::vector<std::string>>(), "<plugin>")
 		("D,define", "set the specified Verilog define to <value> if supplied via command \"read -define\"",
 			cxxopts::value<std::vector<std::string>>(), "<define>[=<value>]")
+		("j,jobs", "run module-local passes on up to <n> threads (only with ENABLE_THREADS builds). " \
+					"The default is taken from the YOSYS_JOBS environment variable, or is 1.",
+			cxxopts::value<int>(), "<n>")
 		("S,synth", "shortcut for calling the \"synth\" command, a default script for transforming " \
 					"the Verilog input to a gate-level netlist. For example: " \
 					"yosys -o output.blif -S input.v " \
@@ -285,11 +289,16 @@ int main(int argc, char **argv)
 			cxxopts::value<uint64_t>(), "<idx>")
 		("hash-seed", "mix up hashing values with <seed>, for extreme optimization and testing",
 			cxxopts::value<uint64_t>(), "<seed>")
+		("compact-auto-ids", "name auto-generated objects $auto$$<idx> instead of $auto$<file>:<line>:<func>$<idx>, " \
+			"keeping the source location in a side table")
 		("A,abort", "will call abort() at the end of the script. for debugging")
 		("x,experimental", "do not print warnings for the experimental <feature>",
 			cxxopts::value<std::vector<std::string>>(), "<feature>")
 		("g,debug", "globally enable debug log messages")
 		("perffile", "write a JSON performance log to <perffile>", cxxopts::value<std::string>(), "<perffile>")
+		("profile", "write the memory usage and design size changes of each pass to <profile>, " \
+			"as JSON that can also be loaded as a Chrome trace. Allocations are only counted when built " \
+			"with ENABLE_ALLOC_PROFILE", cxxopts::value<std::string>(), "<profile>")
 	;
 
 	options.parse_positional({"infile"});
@@ -433,6 +442,10 @@ int main(int argc, char **argv)
 			log_experimentals_ignored.insert(ignores.begin(), ignores.end());
 		}
 		if (result.count("perffile")) perffile = result["perffile"].as<std::string>();
+		if (result.count("profile")) {
+			profilefile = result["profile"].as<std::string>();
+			yosys_profile = true;
+		}
 		if (result.count("infile")) {
 			frontend_files = result["infile"].as<std::vector<std::string>>();
 		}
@@ -440,6 +453,10 @@ int main(int argc, char **argv)
 			int idx = result["autoidx"].as<uint64_t>();
 			autoidx = idx;
 		}
+		if (result.count("compact-auto-ids")) yosys_compact_auto_ids = true;
+		if (getenv("YOSYS_JOBS") != nullptr)
+			yosys_jobs = std::max(atoi(getenv("YOSYS_JOBS")), 1);
+		if (result.count("j")) yosys_jobs = std::max(result["j"].as<int>(), 1);
 		if (result.count("hash-seed")) {
 			int seed = result["hash-seed"].as<uint64_t>();
 			Hasher::set_fudge((Hasher::hash_t)seed);
@@ -724,6 +741,18 @@ int main(int argc, char **argv)
 			}
 			log("%s\n", out_count ? "" : " no commands executed");
 		}
+		if (yosys_profile)
+		{
+			std::vector<std::pair<int64_t, std::string>> memdat;
+			for (auto &it : pass_register)
+				if (it.second->call_counter && it.second->profile_usage.peak_rss_bytes > 0)
+					memdat.push_back(std::make_pair(it.second->profile_usage.peak_rss_bytes, it.first));
+			std::sort(memdat.rbegin(), memdat.rend());
+			log("Peak memory growth:");
+			for (int i = 0; i < GetSize(memdat) && i < 4; i++)
+				log("%s %s %.2f MB", i ? "," : "", memdat[i].second.c_str(), memdat[i].first / (1024.0 * 1024.0));
+			log("%s\n", memdat.empty() ? " none" : "");
+		}
 		if(!perffile.empty())
 		{
 			FILE *f = fopen(perffile.c_str(), "wt");
@@ -749,6 +778,9 @@ int main(int argc, char **argv)
 		}
 	}
 
+	if (!profilefile.empty())
+		profile_write(profilefile);
+
 #if defined(YOSYS_ENABLE_COVER) && (defined(__linux__) || defined(__FreeBSD__))
 	if (getenv("YOSYS_COVER_DIR") || getenv("YOSYS_COVER_FILE"))
 	{
@@ -20,6 +20,17 @@
 #include <type_traits>
 #include <stdint.h>
 
+#ifdef YOSYS_HASHLIB_SWISS
+#  if defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#  elif defined(__ARM_NEON)
+#    include <arm_neon.h>
+#  endif
+#  if defined(_MSC_VER) && !defined(__clang__)
+#    include <intrin.h>
+#  endif
+#endif
+
 #define YS_HASHING_VERSION 1
 
 namespace hashlib {
@@ -50,6 +61,11 @@ namespace hashlib {
  * We implement associative data structures with separate chaining.
  * Linked lists use integers into the indirection hashtable array
  * instead of pointers.
+ *
+ * When built with YOSYS_HASHLIB_SWISS (make ENABLE_HASHLIB_SWISS=1),
+ * the chained index is replaced with an open-addressing one, see
+ * swiss_index below. The entries vector, and thus the iteration order
+ * and the idict indices, are the same with both backends.
  */
 
 const int hashtable_size_trigger = 2;
@@ -352,6 +368,157 @@ inline unsigned int hashtable_size(unsigned int min_size)
 	throw std::length_error("hash table exceeded maximum size.");
 }
 
+#ifdef YOSYS_HASHLIB_SWISS
+/**
+ * Open-addressing index from hashes to positions in the entries vector
+ * of dict and pool, in the style of Swiss tables.
+ *
+ * Slots are organized in groups of 16. Each slot has a control byte,
+ * which is either empty, deleted, or holds the low 7 bits of the hash
+ * of the entry it points to. A lookup starts at the group selected by
+ * the remaining hash bits and compares all 16 control bytes at once
+ * (with SSE2 or NEON when available) before touching any entry, so
+ * that a hit usually costs a single cache miss in the entries.
+ * Groups are probed quadratically until one contains an empty slot.
+ */
+class swiss_index
+{
+	static constexpr int group_size = 16;
+	static constexpr int8_t ctrl_empty = -128;
+	static constexpr int8_t ctrl_deleted = -2;
+
+	std::vector<int8_t> ctrl;
+	std::vector<int> slots;
+	int num_deleted = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+	static constexpr int mask_stride = 1;
+	// Bitmask with one bit per slot of the group whose control byte is `c`.
+	uint64_t match(size_t group, int8_t c) const {
+		__m128i ctrls = _mm_loadu_si128((const __m128i*)&ctrl[group * group_size]);
+		return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrls, _mm_set1_epi8(c)));
+	}
+	// Bitmask with one bit per empty or deleted slot of the group.
+	uint64_t match_free(size_t group) const {
+		return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)&ctrl[group * group_size]));
+	}
+#elif defined(__ARM_NEON)
+	// NEON has no movemask, narrowing the comparison result gives 4 bits per slot instead.
+	static constexpr int mask_stride = 4;
+	static uint64_t to_mask(uint8x16_t cmp) {
+		uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(cmp), 4);
+		return vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ULL;
+	}
+	uint64_t match(size_t group, int8_t c) const {
+		return to_mask(vceqq_s8(vld1q_s8(&ctrl[group * group_size]), vdupq_n_s8(c)));
+	}
+	uint64_t match_free(size_t group) const {
+		return to_mask(vcltq_s8(vld1q_s8(&ctrl[group * group_size]), vdupq_n_s8(0)));
+	}
+#else
+	static constexpr int mask_stride = 1;
+	uint64_t match(size_t group, int8_t c) const {
+		uint64_t mask = 0;
+		for (int i = 0; i < group_size; i++)
+			if (ctrl[group * group_size + i] == c)
+				mask |= uint64_t(1) << i;
+		return mask;
+	}
+	uint64_t match_free(size_t group) const {
+		uint64_t mask = 0;
+		for (int i = 0; i < group_size; i++)
+			if (ctrl[group * group_size + i] < 0)
+				mask |= uint64_t(1) << i;
+		return mask;
+	}
+#endif
+
+	static int first_slot(uint64_t mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+		unsigned long idx;
+		_BitScanForward64(&idx, mask);
+		return idx / mask_stride;
+#else
+		return __builtin_ctzll(mask) / mask_stride;
+#endif
+	}
+
+	size_t group_mask() const { return ctrl.size() / group_size - 1; }
+	static int8_t ctrl_of(uint32_t hash) { return hash & 0x7f; }
+
+public:
+	bool empty() const { return ctrl.empty(); }
+	void clear() { ctrl.clear(); slots.clear(); num_deleted = 0; }
+
+	void swap(swiss_index &other) {
+		ctrl.swap(other.ctrl);
+		slots.swap(other.slots);
+		std::swap(num_deleted, other.num_deleted);
+	}
+
+	// Whether one more entry can be added to the `num_entries` already indexed without exceeding a load of 7/8.
+	bool has_room(size_t num_entries) const {
+		return (num_entries + num_deleted + 1) * 8 <= ctrl.size() * 7;
+	}
+
+	// Drops all the slots and resizes the index for at least `min_entries` entries.
+	void reset(size_t min_entries) {
+		size_t num_slots = group_size;
+		while (num_slots < 2 * min_entries)
+			num_slots *= 2;
+		ctrl.assign(num_slots, ctrl_empty);
+		slots.assign(num_slots, -1);
+		num_deleted = 0;
+	}
+
+	// Returns the slot pointing to the entry with the given hash for which `is_match(entry_index)` holds, or -1.
+	template<typename F>
+	int find(uint32_t hash, F &&is_match) const {
+		if (ctrl.empty())
+			return -1;
+		size_t gmask = group_mask();
+		size_t group = (hash >> 7) & gmask;
+		for (size_t step = 1; ; step++) {
+			for (uint64_t mask = match(group, ctrl_of(hash)); mask; mask &= mask - 1) {
+				int slot = group * group_size + first_slot(mask);
+				if (is_match(slots[slot]))
+					return slot;
+			}
+			if (match(group, ctrl_empty))
+				return -1;
+			group = (group + step) & gmask;
+		}
+	}
+
+	int entry(int slot) const { return slots[slot]; }
+	void retarget(int slot, int entry_index) { slots[slot] = entry_index; }
+
+	// Indexes the entry at `entry_index`, which must not be indexed yet. The caller checks has_room() first.
+	void insert(uint32_t hash, int entry_index) {
+		size_t gmask = group_mask();
+		size_t group = (hash >> 7) & gmask;
+		for (size_t step = 1; ; step++) {
+			uint64_t mask = match_free(group);
+			if (mask) {
+				int slot = group * group_size + first_slot(mask);
+				if (ctrl[slot] == ctrl_deleted)
+					num_deleted--;
+				ctrl[slot] = ctrl_of(hash);
+				slots[slot] = entry_index;
+				return;
+			}
+			group = (group + step) & gmask;
+		}
+	}
+
+	void erase(int slot) {
+		ctrl[slot] = ctrl_deleted;
+		slots[slot] = -1;
+		num_deleted++;
+	}
+};
+#endif
+
 template<typename K, typename T, typename OPS = hash_top_ops<K>> class dict;
 template<typename K, int offset = 0, typename OPS = hash_top_ops<K>> class idict;
 template<typename K, typename OPS = hash_top_ops<K>> class pool;
@@ -370,7 +537,11 @@ class dict {
 		bool operator<(const entry_t &other) const { return udata.first < other.udata.first; }
 	};
 
+#ifdef YOSYS_HASHLIB_SWISS
+	swiss_index hashtable;
+#else
 	std::vector<int> hashtable;
+#endif
 	std::vector<entry_t> entries;
 	OPS ops;
 
@@ -382,6 +553,86 @@ class dict {
 	}
 #endif
 
+#ifdef YOSYS_HASHLIB_SWISS
+	Hasher::hash_t do_hash(const K &key) const
+	{
+		return ops.hash(key).yield();
+	}
+
+	void do_rehash()
+	{
+		if (entries.empty()) {
+			hashtable.clear();
+			return;
+		}
+		hashtable.reset(entries.capacity());
+		for (int i = 0; i < int(entries.size()); i++)
+			hashtable.insert(do_hash(entries[i].udata.first), i);
+	}
+
+	int do_erase(int index, Hasher::hash_t hash)
+	{
+		do_assert(index < int(entries.size()));
+		if (hashtable.empty() || index < 0)
+			return 0;
+
+		int slot = hashtable.find(hash, [index](int i) { return i == index; });
+		do_assert(slot >= 0);
+		hashtable.erase(slot);
+
+		int back_idx = entries.size()-1;
+
+		if (index != back_idx)
+		{
+			Hasher::hash_t back_hash = do_hash(entries[back_idx].udata.first);
+			slot = hashtable.find(back_hash, [back_idx](int i) { return i == back_idx; });
+			do_assert(slot >= 0);
+			hashtable.retarget(slot, index);
+
+			entries[index] = std::move(entries[back_idx]);
+		}
+
+		entries.pop_back();
+
+		if (entries.empty())
+			hashtable.clear();
+
+		return 1;
+	}
+
+	int do_lookup(const K &key, Hasher::hash_t &hash) const
+	{
+		int slot = hashtable.find(hash, [&](int i) { return ops.cmp(entries[i].udata.first, key); });
+		return slot < 0 ? -1 : hashtable.entry(slot);
+	}
+
+	int do_index_back(Hasher::hash_t hash)
+	{
+		if (hashtable.empty() || !hashtable.has_room(entries.size() - 1))
+			do_rehash();
+		else
+			hashtable.insert(hash, entries.size() - 1);
+		return entries.size() - 1;
+	}
+
+	int do_insert(const K &key, Hasher::hash_t &hash)
+	{
+		entries.emplace_back(std::pair<K, T>(key, T()), -1);
+		return do_index_back(hash);
+	}
+
+	int do_insert(const std::pair<K, T> &value, Hasher::hash_t &hash)
+	{
+		entries.emplace_back(value, -1);
+		return do_index_back(hash);
+	}
+
+	int do_insert(std::pair<K, T> &&rvalue, Hasher::hash_t &hash)
+	{
+		entries.emplace_back(std::forward<std::pair<K, T>>(rvalue), -1);
+		return do_index_back(hash);
+	}
+#else
 	Hasher::hash_t do_hash(const K &key) const
 	{
 		Hasher::hash_t hash = 0;
@@ -511,6 +762,7 @@ class dict {
 		}
 		return entries.size() - 1;
 	}
+#endif
 
 public:
 	class const_iterator
@@ -829,7 +1081,11 @@ protected:
 		entry_t(K &&udata, int next) : udata(std::move(udata)), next(next) { }
 	};
 
+#ifdef YOSYS_HASHLIB_SWISS
+	swiss_index hashtable;
+#else
 	std::vector<int> hashtable;
+#endif
 	std::vector<entry_t> entries;
 	OPS ops;
 
@@ -841,6 +1097,80 @@ protected:
 	}
 #endif
 
+#ifdef YOSYS_HASHLIB_SWISS
+	Hasher::hash_t do_hash(const K &key) const
+	{
+		return ops.hash(key).yield();
+	}
+
+	void do_rehash()
+	{
+		if (entries.empty()) {
+			hashtable.clear();
+			return;
+		}
+		hashtable.reset(entries.capacity());
+		for (int i = 0; i < int(entries.size()); i++)
+			hashtable.insert(do_hash(entries[i].udata), i);
+	}
+
+	int do_erase(int index, Hasher::hash_t hash)
+	{
+		do_assert(index < int(entries.size()));
+		if (hashtable.empty() || index < 0)
+			return 0;
+
+		int slot = hashtable.find(hash, [index](int i) { return i == index; });
+		do_assert(slot >= 0);
+		hashtable.erase(slot);
+
+		int back_idx = entries.size()-1;
+
+		if (index != back_idx)
+		{
+			Hasher::hash_t back_hash = do_hash(entries[back_idx].udata);
+			slot = hashtable.find(back_hash, [back_idx](int i) { return i == back_idx; });
+			do_assert(slot >= 0);
+			hashtable.retarget(slot, index);
+
+			entries[index] = std::move(entries[back_idx]);
+		}
+
+		entries.pop_back();
+
+		if (entries.empty())
+			hashtable.clear();
+
+		return 1;
+	}
+
+	int do_lookup(const K &key, Hasher::hash_t &hash) const
+	{
+		int slot = hashtable.find(hash, [&](int i) { return ops.cmp(entries[i].udata, key); });
+		return slot < 0 ? -1 : hashtable.entry(slot);
+	}
+
+	int do_index_back(Hasher::hash_t hash)
+	{
+		if (hashtable.empty() || !hashtable.has_room(entries.size() - 1))
+			do_rehash();
+		else
+			hashtable.insert(hash, entries.size() - 1);
+		return entries.size() - 1;
+	}
+
+	int do_insert(const K &value, Hasher::hash_t &hash)
+	{
+		entries.emplace_back(value, -1);
+		return do_index_back(hash);
+	}
+
+	int do_insert(K &&rvalue, Hasher::hash_t &hash)
+	{
+		entries.emplace_back(std::forward<K>(rvalue), -1);
+		return do_index_back(hash);
+	}
+#else
 	Hasher::hash_t do_hash(const K &key) const
 	{
 		Hasher::hash_t hash = 0;
@@ -952,6 +1282,7 @@ protected:
 		}
 		return entries.size() - 1;
 	}
+#endif
 
 public:
 	class const_iterator
@@ -61,14 +61,18 @@ string log_last_error;
 void (*log_error_atexit)() = NULL;
 void (*log_verific_callback)(int msg_type, const char *message_id, const char* file_path, unsigned int left_line, unsigned int left_col, unsigned int right_line, unsigned int right_col, const char *msg) = NULL;
 
-int log_make_debug = 0;
+YS_THREAD_LOCAL int log_make_debug = 0;
 int log_force_debug = 0;
-int log_debug_suppressed = 0;
+YS_THREAD_LOCAL int log_debug_suppressed = 0;
 
 vector<int> header_count;
-vector<char*> log_id_cache;
-vector<shared_str> string_buf;
-int string_buf_index = -1;
+YS_THREAD_LOCAL vector<char*> log_id_cache;
+YS_THREAD_LOCAL vector<shared_str> string_buf;
+YS_THREAD_LOCAL int string_buf_index = -1;
+
+#ifdef YOSYS_ENABLE_THREADS
+static thread_local LogCapture *log_capture = nullptr;
+#endif
 
 static struct timeval initial_tv = { 0, 0 };
 static bool next_print_log = false;
@@ -101,6 +105,8 @@ int gettimeofday(struct timeval *tv, struct timezone *tz)
 }
 #endif
 
+static void log_emit(const std::string &str, const char *format);
+
 void logv(const char *format, va_list ap)
 {
 	while (format[0] == '\n' && format[1] != 0) {
@@ -116,6 +122,18 @@ void logv(const char *format, va_list ap)
 	if (str.empty())
 		return;
 
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr) {
+		log_capture->entries.push_back({LogCapture::CAPTURE_MESSAGE, std::string(), str});
+		return;
+	}
+#endif
+
+	log_emit(str, format);
+}
+
+static void log_emit(const std::string &str, const char *format)
+{
 	size_t nnl_pos = str.find_last_not_of('\n');
 	if (nnl_pos == std::string::npos)
 		log_newline_count += GetSize(str);
@@ -205,6 +223,14 @@ void logv(const char *format, va_list ap)
 
 void logv_header(RTLIL::Design *design, const char *format, va_list ap)
 {
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr) {
+		std::string str = vstringf(format, ap);
+		log_capture->entries.push_back({LogCapture::CAPTURE_HEADER, std::string(), str, design});
+		return;
+	}
+#endif
+
 	bool pop_errfile = false;
 
 	log_spacer();
@@ -248,6 +274,13 @@ static void logv_warning_with_prefix(const char *prefix,
 	std::string message = vstringf(format, ap);
 	bool suppressed = false;
 
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr) {
+		log_capture->entries.push_back({LogCapture::CAPTURE_WARNING, prefix, message});
+		return;
+	}
+#endif
+
 	for (auto &re : log_nowarn_regexes)
 		if (std::regex_search(message, re))
 			suppressed = true;
@@ -298,6 +331,16 @@ static void logv_warning_with_prefix(const char *prefix,
 	}
 }
 
+#ifdef YOSYS_ENABLE_THREADS
+static void log_warning_with_prefix(const char *prefix, const char *format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	logv_warning_with_prefix(prefix, format, ap);
+	va_end(ap);
+}
+#endif
+
 void logv_warning(const char *format, va_list ap)
 {
 	logv_warning_with_prefix("Warning: ", format, ap);
@@ -334,6 +377,13 @@ void log_file_info(const std::string &filename, int lineno,
 static void logv_error_with_prefix(const char *prefix,
                                    const char *format, va_list ap)
 {
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr) {
+		log_capture->entries.push_back({LogCapture::CAPTURE_ERROR, prefix, vstringf(format, ap)});
+		throw log_cmd_error_exception();
+	}
+#endif
+
 #ifdef EMSCRIPTEN
 	auto backup_log_files = log_files;
 #endif
@@ -379,6 +429,16 @@ static void logv_error_with_prefix(const char *prefix,
 #endif
 }
 
+#ifdef YOSYS_ENABLE_THREADS
+[[noreturn]]
+static void log_error_with_prefix(const char *prefix, const char *format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	logv_error_with_prefix(prefix, format, ap);
+}
+#endif
+
 void logv_error(const char *format, va_list ap)
 {
 	logv_error_with_prefix("ERROR: ", format, ap);
@@ -431,6 +491,13 @@ void log_experimental(const char *format, ...)
 	string s = vstringf(format, ap);
 	va_end(ap);
 
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr) {
+		log_capture->entries.push_back({LogCapture::CAPTURE_EXPERIMENTAL, std::string(), s});
+		return;
+	}
+#endif
+
 	if (log_experimentals_ignored.count(s) == 0 && log_experimentals.count(s) == 0) {
 		log_warning("Feature '%s' is experimental.\n", s.c_str());
 		log_experimentals.insert(s);
@@ -457,6 +524,13 @@ void log_cmd_error(const char *format, ...)
 	va_list ap;
 	va_start(ap, format);
 
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr) {
+		log_capture->entries.push_back({LogCapture::CAPTURE_CMD_ERROR, std::string(), vstringf(format, ap)});
+		throw log_cmd_error_exception();
+	}
+#endif
+
 	if (log_cmd_error_throw) {
 		log_last_error = vstringf(format, ap);
 
@@ -607,8 +681,66 @@ void log_reset_stack()
 	log_flush();
 }
 
+#ifdef YOSYS_ENABLE_THREADS
+void LogCapture::begin()
+{
+	log_capture = this;
+	log_make_debug = make_debug;
+	log_debug_suppressed = 0;
+}
+
+void LogCapture::end()
+{
+	debug_suppressed = log_debug_suppressed;
+	log_capture = nullptr;
+	log_id_cache_clear();
+	string_buf.clear();
+	string_buf_index = -1;
+}
+
+void LogCapture::rewrite(const std::function<std::string(const std::string&)> &func)
+{
+	for (auto &entry : entries) {
+		entry.prefix = func(entry.prefix);
+		entry.message = func(entry.message);
+	}
+}
+
+void LogCapture::replay()
+{
+	std::vector<Entry> replayed;
+	std::swap(replayed, entries);
+	for (auto &entry : replayed)
+		switch (entry.type) {
+		case CAPTURE_MESSAGE:
+			log_emit(entry.message, "%s");
+			break;
+		case CAPTURE_HEADER:
+			log_header(entry.design, "%s", entry.message.c_str());
+			break;
+		case CAPTURE_WARNING:
+			log_warning_with_prefix(entry.prefix.c_str(), "%s", entry.message.c_str());
+			break;
+		case CAPTURE_EXPERIMENTAL:
+			log_experimental("%s", entry.message.c_str());
+			break;
+		case CAPTURE_ERROR:
+			log_error_with_prefix(entry.prefix.c_str(), "%s", entry.message.c_str());
+		case CAPTURE_CMD_ERROR:
+			log_cmd_error("%s", entry.message.c_str());
+		}
+	log_debug_suppressed += debug_suppressed;
+	debug_suppressed = 0;
+}
+#endif
+
 void log_flush()
 {
+#ifdef YOSYS_ENABLE_THREADS
+	if (log_capture != nullptr)
+		return;
+#endif
+
 	for (auto f : log_files)
 		fflush(f);
 
@@ -664,6 +796,11 @@ const char *log_const(const RTLIL::Const &value, bool autoint)
 
 const char *log_id(const RTLIL::IdString &str)
 {
+	// Compact auto IDs are only expanded to their full name when logged.
+	if (yosys_compact_auto_ids && str.begins_with("$auto$$")) {
+		log_id_cache.push_back(strdup(new_id_origin(str).c_str()));
+		return log_id_cache.back();
+	}
 	log_id_cache.push_back(strdup(str.c_str()));
 	const char *p = log_id_cache.back();
 	if (p[0] != '\\')
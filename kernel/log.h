@@ -115,9 +115,9 @@ extern int log_verbose_level;
 extern string log_last_error;
 extern void (*log_error_atexit)();
 
-extern int log_make_debug;
+extern YS_THREAD_LOCAL int log_make_debug;
 extern int log_force_debug;
-extern int log_debug_suppressed;
+extern YS_THREAD_LOCAL int log_debug_suppressed;
 
 void logv(const char *format, va_list ap);
 void logv_header(RTLIL::Design *design, const char *format, va_list ap);
@@ -181,6 +181,36 @@ struct LogMakeDebugHdl {
 	}
 };
 
+#ifdef YOSYS_ENABLE_THREADS
+// The log output of a ModulePass worker, from begin() to end() on the worker thread.
+// Messages, warnings and errors are recorded instead of being written, and replay()
+// then issues them from the main thread, so that the log does not depend on the
+// order in which the workers ran. An error stops the worker with an exception and
+// is only reported when it is replayed.
+struct LogCapture
+{
+	enum EntryType { CAPTURE_MESSAGE, CAPTURE_HEADER, CAPTURE_WARNING, CAPTURE_EXPERIMENTAL, CAPTURE_ERROR, CAPTURE_CMD_ERROR };
+
+	struct Entry
+	{
+		EntryType type;
+		std::string prefix, message;
+		RTLIL::Design *design = nullptr;
+	};
+
+	std::vector<Entry> entries;
+	int make_debug = log_make_debug;
+	int debug_suppressed = 0;
+
+	void begin();
+	void end();
+	// Applies the given function to the text of the recorded entries before they are
+	// replayed, e.g. to give the objects they name their final names
+	void rewrite(const std::function<std::string(const std::string&)> &func);
+	void replay();
+};
+#endif
+
 void log_spacer();
 void log_push();
 void log_pop();
@@ -81,6 +81,16 @@ struct ModIndex : public RTLIL::Monitor
 	int auto_reload_counter;
 	bool auto_reload_module;
 
+	// For the shared index of the module (RTLIL::Module::index()): the generation of
+	// the module up to which the index has seen all changes
+	bool shared = false;
+	uint64_t generation = 0;
+
+	bool out_of_date() const
+	{
+		return shared && generation != module->generation;
+	}
+
 	void port_add(RTLIL::Cell *cell, RTLIL::IdString port, const RTLIL::SigSpec &sig)
 	{
 		for (int i = 0; i < GetSize(sig); i++) {
@@ -130,12 +140,13 @@ struct ModIndex : public RTLIL::Monitor
 				log_warning("Auto-reload in ModIndex -- possible performance bug!\n");
 			auto_reload_module = false;
 		}
+		generation = module->generation;
 	}
 
 	void check()
 	{
 #ifndef NDEBUG
-		if (auto_reload_module)
+		if (auto_reload_module || out_of_date())
 			return;
 
 		for (auto it : database)
@@ -165,7 +176,7 @@ struct ModIndex : public RTLIL::Monitor
 	{
 		log_assert(module == cell->module);
 
-		if (auto_reload_module)
+		if (auto_reload_module || out_of_date())
 			return;
 
 		port_del(cell, port, old_sig);
@@ -176,7 +187,7 @@ struct ModIndex : public RTLIL::Monitor
 	{
 		log_assert(module == mod);
 
-		if (auto_reload_module)
+		if (auto_reload_module || out_of_date())
 			return;
 
 		for (int i = 0; i < GetSize(sigsig.first); i++)
@@ -243,7 +254,7 @@ struct ModIndex : public RTLIL::Monitor
 
 	SigBitInfo *query(RTLIL::SigBit bit)
 	{
-		if (auto_reload_module)
+		if (auto_reload_module || out_of_date())
 			reload_module();
 
 		auto it = database.find(sigmap(bit));
@@ -282,7 +293,7 @@ struct ModIndex : public RTLIL::Monitor
 	{
 		log("--- ModIndex Dump ---\n");
 
-		if (auto_reload_module) {
+		if (auto_reload_module || out_of_date()) {
 			log("AUTO-RELOAD\n");
 			reload_module();
 		}
@@ -0,0 +1,258 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/profile.h"
+#include "kernel/yosys.h"
+#include "kernel/json.h"
+
+#include <chrono>
+#include <new>
+
+#if !defined(_WIN32)
+#  include <sys/resource.h>
+#  include <unistd.h>
+#endif
+
+USING_YOSYS_NAMESPACE
+
+#ifdef YOSYS_ENABLE_ALLOC_PROFILE
+// Counted for the whole process, but only while profiling, so that the other
+// runs only pay for the test of the flag.
+
+#ifdef YOSYS_ENABLE_THREADS
+static std::atomic<int64_t> process_alloc_count, process_alloc_bytes;
+#else
+static int64_t process_alloc_count, process_alloc_bytes;
+#endif
+
+static void *profile_alloc(size_t size)
+{
+	if (yosys_profile) {
+#ifdef YOSYS_ENABLE_THREADS
+		process_alloc_count.fetch_add(1, std::memory_order_relaxed);
+		process_alloc_bytes.fetch_add(size, std::memory_order_relaxed);
+#else
+		process_alloc_count++;
+		process_alloc_bytes += size;
+#endif
+	}
+	if (size == 0)
+		size = 1;
+	while (true) {
+		void *ptr = malloc(size);
+		if (ptr != nullptr)
+			return ptr;
+		std::new_handler handler = std::get_new_handler();
+		if (handler == nullptr)
+			throw std::bad_alloc();
+		handler();
+	}
+}
+
+void *operator new(size_t size)
+{
+	return profile_alloc(size);
+}
+
+void *operator new[](size_t size)
+{
+	return profile_alloc(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	try {
+		return profile_alloc(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void *operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	try {
+		return profile_alloc(size);
+	} catch (...) {
+		return nullptr;
+	}
+}
+
+void operator delete(void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+	free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+	free(ptr);
+}
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+bool yosys_profile = false;
+std::vector<ProfileEvent> yosys_profile_events;
+
+ProfileSample ProfileSample::query()
+{
+	ProfileSample s;
+
+	static const auto start = std::chrono::steady_clock::now();
+	s.wall_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+#if defined(__linux__)
+	FILE *f = fopen("/proc/self/statm", "r");
+	if (f != nullptr) {
+		long size, resident;
+		if (fscanf(f, "%ld %ld", &size, &resident) == 2)
+			s.rss_bytes = int64_t(resident) * sysconf(_SC_PAGESIZE);
+		fclose(f);
+	}
+#endif
+#if defined(__linux__) || defined(__FreeBSD__)
+	struct rusage rusage;
+	if (getrusage(RUSAGE_SELF, &rusage) == 0)
+		s.peak_rss_bytes = int64_t(rusage.ru_maxrss) * 1024;
+#elif defined(__APPLE__)
+	struct rusage rusage;
+	if (getrusage(RUSAGE_SELF, &rusage) == 0)
+		s.peak_rss_bytes = rusage.ru_maxrss;
+#endif
+
+#ifdef YOSYS_ENABLE_ALLOC_PROFILE
+	s.alloc_count = process_alloc_count;
+	s.alloc_bytes = process_alloc_bytes;
+#endif
+
+	RTLIL::Design *design = yosys_get_design();
+	if (design != nullptr)
+		for (auto module : design->modules()) {
+			s.cells += GetSize(module->cells_);
+			s.wires += GetSize(module->wires_);
+		}
+	s.idstrings = RTLIL::IdString::live_count();
+
+	return s;
+}
+
+ProfileSample &ProfileSample::operator+=(const ProfileSample &other)
+{
+	wall_ns += other.wall_ns;
+	rss_bytes += other.rss_bytes;
+	peak_rss_bytes += other.peak_rss_bytes;
+	alloc_count += other.alloc_count;
+	alloc_bytes += other.alloc_bytes;
+	cells += other.cells;
+	wires += other.wires;
+	idstrings += other.idstrings;
+	return *this;
+}
+
+ProfileSample &ProfileSample::operator-=(const ProfileSample &other)
+{
+	wall_ns -= other.wall_ns;
+	rss_bytes -= other.rss_bytes;
+	peak_rss_bytes -= other.peak_rss_bytes;
+	alloc_count -= other.alloc_count;
+	alloc_bytes -= other.alloc_bytes;
+	cells -= other.cells;
+	wires -= other.wires;
+	idstrings -= other.idstrings;
+	return *this;
+}
+
+static void profile_entries(PrettyJson &json, const ProfileSample &s)
+{
+	// bytes and counts may not fit into the int of the json values
+	json.entry("rss_delta_bytes", double(s.rss_bytes));
+	json.entry("peak_rss_delta_bytes", double(s.peak_rss_bytes));
+#ifdef YOSYS_ENABLE_ALLOC_PROFILE
+	json.entry("alloc_count", double(s.alloc_count));
+	json.entry("alloc_bytes", double(s.alloc_bytes));
+#endif
+	json.entry("cells_delta", double(s.cells));
+	json.entry("wires_delta", double(s.wires));
+	json.entry("idstrings_delta", double(s.idstrings));
+}
+
+void profile_write(const std::string &filename)
+{
+	PrettyJson json;
+	if (!json.write_to_file(filename))
+		log_error("Can't open profile file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+
+	json.begin_object();
+	json.entry("generator", yosys_version_str);
+
+	// Totals without the nested calls, like the runtime in the end of run report
+	json.name("passes");
+	json.begin_object();
+	for (auto &it : pass_register) {
+		Pass *pass = it.second;
+		if (!pass->call_counter)
+			continue;
+		json.name(it.first.c_str());
+		json.begin_object();
+		json.entry("num_calls", pass->call_counter);
+		json.entry("runtime_ns", double(pass->runtime_ns));
+		json.entry("wall_ns", double(pass->profile_usage.wall_ns));
+		profile_entries(json, pass->profile_usage);
+		json.end_object();
+	}
+	json.end_object();
+
+	json.entry("displayTimeUnit", "ms");
+	json.name("traceEvents");
+	json.begin_array();
+	for (auto &event : yosys_profile_events) {
+		ProfileSample delta = event.end - event.begin;
+		json.begin_object();
+		json.compact();
+		json.entry("name", event.pass_name);
+		json.entry("cat", "pass");
+		json.entry("ph", "X");
+		json.entry("ts", event.begin.wall_ns / 1000.0);
+		json.entry("dur", delta.wall_ns / 1000.0);
+		json.entry("pid", 1);
+		json.entry("tid", 1);
+		json.name("args");
+		json.begin_object();
+		json.entry("depth", event.depth);
+		json.entry("rss_bytes", double(event.end.rss_bytes));
+		profile_entries(json, delta);
+		json.end_object();
+		json.end_object();
+	}
+	json.end_array();
+
+	json.end_object();
+	json.flush();
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,73 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "kernel/yosys_common.h"
+
+// The allocation counters (ENABLE_ALLOC_PROFILE) replace the global operator new,
+// which would hide mismatched new/delete pairs from the sanitizers.
+#if defined(YOSYS_ENABLE_ALLOC_PROFILE) && defined(__SANITIZE_ADDRESS__)
+#  undef YOSYS_ENABLE_ALLOC_PROFILE
+#endif
+#if defined(YOSYS_ENABLE_ALLOC_PROFILE) && defined(__has_feature)
+#  if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#    undef YOSYS_ENABLE_ALLOC_PROFILE
+#  endif
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+// Resource usage of the process and size of the current design, as sampled around
+// each pass call while profiling (`yosys --profile <file>`). The differences
+// between two samples are accumulated per pass, like Pass::runtime_ns.
+struct ProfileSample
+{
+	int64_t wall_ns = 0;
+	int64_t rss_bytes = 0, peak_rss_bytes = 0;
+	int64_t alloc_count = 0, alloc_bytes = 0;
+	int64_t cells = 0, wires = 0, idstrings = 0;
+
+	static ProfileSample query();
+
+	ProfileSample &operator+=(const ProfileSample &other);
+	ProfileSample &operator-=(const ProfileSample &other);
+	ProfileSample operator-(const ProfileSample &other) const { ProfileSample s = *this; s -= other; return s; }
+};
+
+// One call of a pass, with the totals of the nested calls included.
+struct ProfileEvent
+{
+	std::string pass_name;
+	int depth;
+	ProfileSample begin, end;
+};
+
+extern bool yosys_profile;
+extern std::vector<ProfileEvent> yosys_profile_events;
+
+// Writes the summary per pass and the trace of all the calls. The trace uses the
+// Chrome trace event format, which ignores the other entries of the top object, so
+// that the file can be loaded as is into chrome://tracing or Perfetto.
+void profile_write(const std::string &filename);
+
+YOSYS_NAMESPACE_END
+
+#endif
@@ -92,6 +92,7 @@ YOSYS_NAMESPACE_BEGIN
 bool echo_mode = false;
 Pass *first_queued_pass;
 Pass *current_pass;
+static int profile_depth;
 
 std::map<std::string, Frontend*> frontend_register;
 std::map<std::string, Pass*> pass_register;
@@ -155,6 +156,11 @@ Pass::pre_post_exec_state_t Pass::pre_execute()
 	call_counter++;
 	state.begin_ns = PerformanceTimer::query();
 	state.parent_pass = current_pass;
+	state.profile_event = -1;
+	if (yosys_profile) {
+		state.profile_event = GetSize(yosys_profile_events);
+		yosys_profile_events.push_back({pass_name, profile_depth++, ProfileSample::query(), ProfileSample()});
+	}
 	current_pass = this;
 	clear_flags();
 	return state;
@@ -170,6 +176,16 @@ void Pass::post_execute(Pass::pre_post_exec_state_t state)
 	current_pass = state.parent_pass;
 	if (current_pass)
 		current_pass->runtime_ns -= time_ns;
+
+	if (state.profile_event >= 0) {
+		ProfileEvent &event = yosys_profile_events[state.profile_event];
+		event.end = ProfileSample::query();
+		ProfileSample usage = event.end - event.begin;
+		profile_usage += usage;
+		if (current_pass)
+			current_pass->profile_usage -= usage;
+		profile_depth--;
+	}
 }
 
 void Pass::help()
@@ -439,6 +455,192 @@ void ScriptPass::help_script()
 	script();
 }
 
+void ModulePass::run_on_modules(const std::vector<RTLIL::Module*> &modules)
+{
+	run_on_modules(modules, [this](RTLIL::Module *module) { execute_module(module); });
+}
+
+#ifdef YOSYS_ENABLE_THREADS
+// Shifts the index of the NEW_ID names created on a worker thread, i.e. with an index
+// in [begin, end), by the given offset. The index of a NEW_ID name is the number after
+// its last '$', which also covers the names of NEW_ID_SUFFIX and the names derived
+// from them.
+struct AutoIdShift
+{
+	int begin, end, offset;
+
+	// Finds the next name starting with "$auto$" at or after pos, and returns the
+	// position of its index digits, or std::string::npos
+	static size_t find_index(const std::string &text, size_t &pos, size_t &digits_end)
+	{
+		for (pos = text.find("$auto$", pos); pos != std::string::npos; pos = text.find("$auto$", pos + 1)) {
+			size_t name_end = text.find_first_of(" \t\r\n'\"`,;()[]{}", pos);
+			if (name_end == std::string::npos)
+				name_end = text.size();
+			size_t digits = text.rfind('$', name_end - 1) + 1;
+			digits_end = digits;
+			while (digits_end < name_end && digits_end - digits < 10 && isdigit((unsigned char)text[digits_end]))
+				digits_end++;
+			if (digits_end > digits)
+				return digits;
+		}
+		return std::string::npos;
+	}
+
+	// Returns the index of the first shifted name in text, or -1
+	int shifted_index(const std::string &text) const
+	{
+		size_t pos = 0, digits, digits_end;
+		for (; (digits = find_index(text, pos, digits_end)) != std::string::npos; pos = digits_end) {
+			long long idx = atoll(text.substr(digits, digits_end - digits).c_str());
+			if (idx >= begin && idx < end)
+				return idx;
+		}
+		return -1;
+	}
+
+	std::string apply(const std::string &text) const
+	{
+		if (offset == 0 || text.find("$auto$") == std::string::npos)
+			return text;
+		std::string result;
+		size_t copied = 0, pos = 0, digits, digits_end;
+		for (; (digits = find_index(text, pos, digits_end)) != std::string::npos; pos = digits_end) {
+			long long idx = atoll(text.substr(digits, digits_end - digits).c_str());
+			if (idx < begin || idx >= end)
+				continue;
+			result += text.substr(copied, digits - copied) + std::to_string(idx + offset);
+			copied = digits_end;
+		}
+		return result + text.substr(copied);
+	}
+};
+
+// Renames the objects in place, keeping the order of the dict, so that the result is the
+// same as if the objects had been created with the new names
+template<typename T>
+static void renumber_auto_ids(dict<RTLIL::IdString, T*> &objects, const AutoIdShift &shift)
+{
+	std::vector<std::pair<RTLIL::IdString, T*>> entries;
+	bool changed = false;
+	for (auto &it : objects) {
+		RTLIL::IdString new_name = it.first;
+		if (it.first.begins_with("$auto$") && shift.shifted_index(it.first.str()) >= 0) {
+			new_name = shift.apply(it.first.str());
+			it.second->name = new_name;
+			changed = true;
+		}
+		entries.push_back({new_name, it.second});
+	}
+	if (!changed)
+		return;
+
+	// The dict iterates from the last inserted entry
+	objects.clear();
+	for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+		log_assert(!objects.count(it->first));
+		objects[it->first] = it->second;
+	}
+}
+
+// Gives the wires, cells, memories and processes named on a worker thread the names of
+// a serial run
+static void renumber_auto_ids(RTLIL::Module *module, const AutoIdShift &shift)
+{
+	renumber_auto_ids(module->wires_, shift);
+	renumber_auto_ids(module->cells_, shift);
+	renumber_auto_ids(module->memories, shift);
+	renumber_auto_ids(module->processes, shift);
+	module->touch();
+
+	// The memory cells refer to their memory by name
+	for (auto cell : module->cells())
+		if (cell->hasParam(ID::MEMID)) {
+			std::string memid = cell->getParam(ID::MEMID).decode_string();
+			std::string new_memid = shift.apply(memid);
+			if (new_memid != memid)
+				cell->setParam(ID::MEMID, RTLIL::Const(new_memid));
+		}
+}
+#endif
+
+void ModulePass::run_on_modules(const std::vector<RTLIL::Module*> &modules, const std::function<void(RTLIL::Module*)> &func)
+{
+#ifdef YOSYS_ENABLE_THREADS
+	int num_threads = std::min(yosys_jobs, GetSize(modules));
+	// Design monitors (e.g. `trace`) are notified of the changes to all the modules. With
+	// compact auto IDs, the call site of each index is recorded in a global side table.
+	if (num_threads > 1 && !yosys_compact_auto_ids && !yosys_threads_running && modules.front()->design->monitors.empty())
+	{
+		int base_autoidx = autoidx;
+
+		// Largest modules first, so that they do not end up alone on the last thread
+		std::vector<int> order;
+		for (int i = 0; i < GetSize(modules); i++)
+			order.push_back(i);
+		auto module_size = [&](int i) { return modules[i]->cells_.size() + modules[i]->wires_.size(); };
+		std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return module_size(a) > module_size(b); });
+
+		std::vector<LogCapture> captures(GetSize(modules));
+		std::vector<std::exception_ptr> errors(GetSize(modules));
+		std::vector<int> module_autoidx(GetSize(modules), base_autoidx);
+		std::atomic<int> next_order{0};
+		std::atomic<bool> failed{false};
+
+		auto worker = [&]() {
+			for (int i = next_order++; i < GetSize(order) && !failed; i = next_order++) {
+				int idx = order[i];
+				captures[idx].begin();
+				autoidx = base_autoidx;
+				try {
+					func(modules[idx]);
+				} catch (...) {
+					errors[idx] = std::current_exception();
+					failed = true;
+				}
+				module_autoidx[idx] = autoidx;
+				captures[idx].end();
+			}
+		};
+
+		yosys_threads_running = true;
+		std::vector<std::thread> threads;
+		for (int i = 0; i < num_threads; i++)
+			threads.emplace_back(worker);
+		for (auto &thread : threads)
+			thread.join();
+		yosys_threads_running = false;
+
+		// Every thread numbered its names from the same base. Shifting them as if the
+		// modules had been run one after the other gives the objects and the log
+		// messages the names of a serial run.
+		std::vector<AutoIdShift> shifts;
+		int offset = 0;
+		for (int idx = 0; idx < GetSize(modules); idx++) {
+			shifts.push_back({base_autoidx, module_autoidx[idx], offset});
+			offset += module_autoidx[idx] - base_autoidx;
+		}
+
+		for (int idx = 0; idx < GetSize(modules); idx++)
+			if (shifts[idx].offset > 0 && shifts[idx].end > shifts[idx].begin)
+				renumber_auto_ids(modules[idx], shifts[idx]);
+		autoidx = base_autoidx + offset;
+
+		// An error that went through log_error() is reported by its replay
+		for (int idx = 0; idx < GetSize(modules); idx++) {
+			captures[idx].rewrite([&](const std::string &text) { return shifts[idx].apply(text); });
+			captures[idx].replay();
+			if (errors[idx])
+				std::rethrow_exception(errors[idx]);
+		}
+		return;
+	}
+#endif
+
+	for (auto module : modules)
+		func(module);
+}
+
 Frontend::Frontend(std::string name, std::string short_help) :
 		Pass(name.rfind("=", 0) == 0 ? name.substr(1) : "read_" + name, short_help),
 		frontend_name(name.rfind("=", 0) == 0 ? name.substr(1) : name)
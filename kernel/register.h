@@ -22,6 +22,7 @@
 
 #include "kernel/yosys_common.h"
 #include "kernel/yosys.h"
+#include "kernel/profile.h"
 
 YOSYS_NAMESPACE_BEGIN
 
@@ -37,6 +38,7 @@ struct Pass
 
 	int call_counter;
 	int64_t runtime_ns;
+	ProfileSample profile_usage;
 	bool experimental_flag = false;
 
 	void experimental() {
@@ -46,6 +48,7 @@ struct Pass
 	struct pre_post_exec_state_t {
 		Pass *parent_pass;
 		int64_t begin_ns;
+		int profile_event;
 	};
 
 	pre_post_exec_state_t pre_execute();
@@ -91,6 +94,25 @@ struct ScriptPass : Pass
 	void help_script();
 };
 
+// A pass whose work is local to each module. execute() parses the arguments and then
+// calls run_on_modules(), which hands the modules to execute_module(), on up to
+// `yosys_jobs` threads when built with ENABLE_THREADS. execute_module() may only
+// modify its own module, and must not change the design, call other passes or update
+// the pass state without synchronisation. The log output of each module is replayed
+// in module order, and the NEW_ID names of the objects created on the threads (and the
+// log lines naming them) are renumbered after the join as in a serial run, so that the
+// result does not depend on the number of threads.
+struct ModulePass : Pass
+{
+	ModulePass(std::string name, std::string short_help = "** document me **") : Pass(name, short_help) { }
+
+	virtual void execute_module(RTLIL::Module *module) = 0;
+	void run_on_modules(const std::vector<RTLIL::Module*> &modules);
+
+	// The same for other commands, e.g. the backends that write each module on its own
+	static void run_on_modules(const std::vector<RTLIL::Module*> &modules, const std::function<void(RTLIL::Module*)> &func);
+};
+
 struct Frontend : Pass
 {
 	// for reading of here documents
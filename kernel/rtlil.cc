@@ -22,6 +22,7 @@
 #include "kernel/celltypes.h"
 #include "kernel/binding.h"
 #include "kernel/sigtools.h"
+#include "kernel/modtools.h"
 #include "frontends/verilog/verilog_frontend.h"
 #include "frontends/verilog/preproc.h"
 #include "backends/rtlil/rtlil_backend.h"
@@ -34,6 +35,196 @@ YOSYS_NAMESPACE_BEGIN
 
 bool RTLIL::IdString::destruct_guard_ok = false;
 RTLIL::IdString::destruct_guard_t RTLIL::IdString::destruct_guard;
+#ifdef YOSYS_ENABLE_THREADS
+RTLIL::IdString::id_entry RTLIL::IdString::global_id_chunk0_[1 << id_chunk_bits] = { { (char*)"", 0 } };
+std::atomic<RTLIL::IdString::id_entry*> RTLIL::IdString::global_id_chunks_[id_max_chunks] = { global_id_chunk0_ };
+std::atomic<int> RTLIL::IdString::global_id_count_{1};
+RTLIL::IdString::id_shard RTLIL::IdString::global_id_shards_[id_num_shards];
+
+// indices whose refcount dropped to zero, waiting for the next checkpoint()
+static std::mutex id_pending_mutex;
+static std::vector<int> id_pending_list;
+
+// released indices, handed out in batches to the per-thread free lists
+static std::mutex id_free_mutex;
+static std::vector<int> id_free_list;
+
+static std::mutex id_checkpoint_mutex;
+
+static thread_local bool id_thread_lists_alive;
+
+static struct IdThreadLists
+{
+	std::vector<int> pending, free;
+
+	IdThreadLists() { id_thread_lists_alive = true; }
+
+	void flush_pending() {
+		std::lock_guard<std::mutex> lock(id_pending_mutex);
+		id_pending_list.insert(id_pending_list.end(), pending.begin(), pending.end());
+		pending.clear();
+	}
+
+	~IdThreadLists() {
+		id_thread_lists_alive = false;
+		flush_pending();
+		std::lock_guard<std::mutex> lock(id_free_mutex);
+		id_free_list.insert(id_free_list.end(), free.begin(), free.end());
+	}
+} thread_local id_thread_lists;
+
+static int new_id_index()
+{
+	std::vector<int> &free_list = id_thread_lists.free;
+	if (free_list.empty()) {
+		std::lock_guard<std::mutex> lock(id_free_mutex);
+		size_t n = std::min<size_t>(id_free_list.size(), 256);
+		free_list.assign(id_free_list.end() - n, id_free_list.end());
+		id_free_list.resize(id_free_list.size() - n);
+	}
+	if (!free_list.empty()) {
+		int idx = free_list.back();
+		free_list.pop_back();
+		return idx;
+	}
+
+	int idx = RTLIL::IdString::global_id_count_.fetch_add(1);
+	log_assert(idx < 0x40000000);
+	auto &chunk = RTLIL::IdString::global_id_chunks_[idx >> RTLIL::IdString::id_chunk_bits];
+	if (chunk.load(std::memory_order_acquire) == nullptr) {
+		auto *new_chunk = new RTLIL::IdString::id_entry[1 << RTLIL::IdString::id_chunk_bits]();
+		RTLIL::IdString::id_entry *expected = nullptr;
+		if (!chunk.compare_exchange_strong(expected, new_chunk, std::memory_order_acq_rel))
+			delete[] new_chunk;
+	}
+	return idx;
+}
+
+int RTLIL::IdString::get_reference(const char *p)
+{
+	log_assert(destruct_guard_ok);
+
+	if (!p[0])
+		return 0;
+
+	id_shard &shard = get_shard(p);
+	std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+	if (yosys_threads_running)
+		lock.lock();
+
+	auto it = shard.index.find((char*)p);
+	if (it != shard.index.end())
+		return get_reference(it->second);
+
+	log_assert(p[0] == '$' || p[0] == '\\');
+	log_assert(p[1] != 0);
+	for (const char *c = p; *c; c++)
+		if ((unsigned)*c <= (unsigned)' ')
+			log_error("Found control character or space (0x%02x) in string '%s' which is not allowed in RTLIL identifiers\n", *c, p);
+
+	int idx = new_id_index();
+	id_entry &entry = get_entry(idx);
+	char *str = strdup(p);
+	entry.refcount.store(1, std::memory_order_relaxed);
+	entry.str.store(str, std::memory_order_release);
+	shard.index[str] = idx;
+
+	if (yosys_xtrace) {
+		log("#X# New IdString '%s' with index %d.\n", p, idx);
+		log_backtrace("-X- ", yosys_xtrace-1);
+	}
+
+	return idx;
+}
+
+void RTLIL::IdString::defer_free_reference(int idx)
+{
+	if (!id_thread_lists_alive) {
+		std::lock_guard<std::mutex> lock(id_pending_mutex);
+		id_pending_list.push_back(idx);
+		return;
+	}
+
+	id_thread_lists.pending.push_back(idx);
+	if (GetSize(id_thread_lists.pending) >= 256)
+		id_thread_lists.flush_pending();
+}
+
+void RTLIL::IdString::free_reference(int idx)
+{
+	id_entry &entry = get_entry(idx);
+	char *p = entry.str.load(std::memory_order_relaxed);
+
+	if (yosys_xtrace) {
+		log("#X# Removed IdString '%s' with index %d.\n", p, idx);
+		log_backtrace("-X- ", yosys_xtrace-1);
+	}
+
+	get_shard(p).index.erase(p);
+	entry.str.store(nullptr, std::memory_order_relaxed);
+	free(p);
+	if (id_thread_lists_alive)
+		id_thread_lists.free.push_back(idx);
+	else {
+		std::lock_guard<std::mutex> lock(id_free_mutex);
+		id_free_list.push_back(idx);
+	}
+}
+
+void RTLIL::IdString::checkpoint()
+{
+	// only one thread releases entries at a time, so that the strings of the pending
+	// entries stay valid while their shard is looked up
+	std::unique_lock<std::mutex> checkpoint_lock(id_checkpoint_mutex, std::try_to_lock);
+	if (!checkpoint_lock.owns_lock())
+		return;
+
+	if (id_thread_lists_alive)
+		id_thread_lists.flush_pending();
+
+	std::vector<int> pending;
+	{
+		std::lock_guard<std::mutex> lock(id_pending_mutex);
+		pending.swap(id_pending_list);
+	}
+
+	std::vector<int> released;
+	for (int idx : pending) {
+		id_entry &entry = get_entry(idx);
+		char *p = entry.str.load(std::memory_order_acquire);
+		if (p == nullptr || entry.refcount.load(std::memory_order_relaxed) != 0)
+			continue;
+
+		id_shard &shard = get_shard(p);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (entry.refcount.load(std::memory_order_relaxed) != 0)
+			continue;
+
+		if (yosys_xtrace) {
+			log("#X# Removed IdString '%s' with index %d.\n", p, idx);
+			log_backtrace("-X- ", yosys_xtrace-1);
+		}
+
+		shard.index.erase(p);
+		entry.str.store(nullptr, std::memory_order_relaxed);
+		free(p);
+		released.push_back(idx);
+	}
+
+	std::lock_guard<std::mutex> lock(id_free_mutex);
+	id_free_list.insert(id_free_list.end(), released.begin(), released.end());
+}
+
+int RTLIL::IdString::live_count()
+{
+	int count = 0;
+	for (auto &shard : global_id_shards_) {
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		count += GetSize(shard.index);
+	}
+	return count;
+}
+#else
 std::vector<char*> RTLIL::IdString::global_id_storage_;
 dict<char*, int> RTLIL::IdString::global_id_index_;
 #ifndef YOSYS_NO_IDS_REFCNT
@@ -45,6 +236,12 @@ int RTLIL::IdString::last_created_idx_[8];
 int RTLIL::IdString::last_created_idx_ptr_;
 #endif
 
+int RTLIL::IdString::live_count()
+{
+	return GetSize(global_id_index_);
+}
+#endif
+
 #define X(_id) IdString RTLIL::ID::_id;
 #include "kernel/constids.inc"
 #undef X
@@ -209,15 +406,58 @@ Const::bitvectype& Const::get_bits() const {
 	return *get_if_bits();
 }
 
-std::string& Const::get_str() const {
+const std::string& Const::get_str() const {
 	check(is_str());
 	return *get_if_str();
 }
 
+// The entries are never moved by the node-based map, so that they can be referred to
+// by pointer. The pool is never destroyed, as static Const objects may outlive it.
+std::unordered_map<std::string, Const::str_refcount> &Const::str_pool()
+{
+	static auto *pool = new std::unordered_map<std::string, Const::str_refcount>;
+	return *pool;
+}
+
+#ifdef YOSYS_ENABLE_THREADS
+// Copies only increment the refcount of an entry they already hold, but releasing
+// and interning take the lock, so that no entry is revived while it is erased.
+static std::mutex const_str_mutex;
+#endif
+
+Const::str_entry *Const::intern_str(const std::string &str)
+{
+#ifdef YOSYS_ENABLE_THREADS
+	std::unique_lock<std::mutex> lock(const_str_mutex, std::defer_lock);
+	if (yosys_threads_running)
+		lock.lock();
+#endif
+	auto &pool = str_pool();
+	auto it = pool.find(str);
+	if (it == pool.end())
+		it = pool.emplace(std::piecewise_construct, std::forward_as_tuple(str), std::forward_as_tuple(0)).first;
+	it->second++;
+	return &*it;
+}
+
+void Const::release_str(str_entry *entry)
+{
+#ifdef YOSYS_ENABLE_THREADS
+	std::unique_lock<std::mutex> lock(const_str_mutex, std::defer_lock);
+	if (yosys_threads_running)
+		lock.lock();
+#endif
+	log_assert(entry->second > 0);
+	if (--entry->second == 0) {
+		auto &pool = str_pool();
+		pool.erase(pool.find(entry->first));
+	}
+}
+
 RTLIL::Const::Const(const std::string &str)
 {
 	flags = RTLIL::CONST_FLAG_STRING;
-	new ((void*)&str_) std::string(str);
+	str_ = intern_str(str);
 	tag = backing_tag::string;
 }
 
@@ -259,9 +499,10 @@ RTLIL::Const::Const(const std::vector<bool> &bits)
 RTLIL::Const::Const(const RTLIL::Const &other) {
 	tag = other.tag;
 	flags = other.flags;
-	if (is_str())
-		new ((void*)&str_) std::string(other.get_str());
-	else if (is_bits())
+	if (is_str()) {
+		str_ = other.str_;
+		str_->second++;
+	} else if (is_bits())
 		new ((void*)&bits_) bitvectype(other.get_bits());
 	else
 		check(false);
@@ -270,9 +511,11 @@ RTLIL::Const::Const(const RTLIL::Const &other) {
 RTLIL::Const::Const(RTLIL::Const &&other) {
 	tag = other.tag;
 	flags = other.flags;
-	if (is_str())
-		new ((void*)&str_) std::string(std::move(other.get_str()));
-	else if (is_bits())
+	if (is_str()) {
+		// Sharing the entry is as cheap as stealing it, and leaves other intact
+		str_ = other.str_;
+		str_->second++;
+	} else if (is_bits())
 		new ((void*)&bits_) bitvectype(std::move(other.get_bits()));
 	else
 		check(false);
@@ -281,19 +524,23 @@ RTLIL::Const::Const(RTLIL::Const &&other) {
 RTLIL::Const &RTLIL::Const::operator =(const RTLIL::Const &other) {
 	flags = other.flags;
 	if (other.is_str()) {
-		if (!is_str()) {
+		// Acquire before releasing, in case of self-assignment
+		str_entry *entry = other.str_;
+		entry->second++;
+		if (is_str()) {
+			release_str(str_);
+		} else {
 			// sketchy zone
 			check(is_bits());
 			bits_.~bitvectype();
-			(void)new ((void*)&str_) std::string();
 		}
+		str_ = entry;
 		tag = other.tag;
-		get_str() = other.get_str();
 	} else if (other.is_bits()) {
 		if (!is_bits()) {
 			// sketchy zone
 			check(is_str());
-			str_.~string();
+			release_str(str_);
 			(void)new ((void*)&bits_) bitvectype();
 		}
 		tag = other.tag;
@@ -308,7 +555,7 @@ RTLIL::Const::~Const() {
 	if (is_bits())
 		bits_.~bitvectype();
 	else if (is_str())
-		str_.~string();
+		release_str(str_);
 	else
 		check(false);
 }
@@ -327,6 +574,9 @@ bool RTLIL::Const::operator<(const RTLIL::Const &other) const
 
 bool RTLIL::Const::operator ==(const RTLIL::Const &other) const
 {
+	if (is_str() && other.is_str())
+		return str_ == other.str_;
+
 	if (size() != other.size())
 		return false;
 
@@ -499,7 +749,7 @@ std::string RTLIL::Const::decode_string() const
 
 int RTLIL::Const::size() const {
 	if (is_str())
-		return 8 * str_.size();
+		return 8 * str_->first.size();
 	else {
 		check(is_bits());
 		return bits_.size();
@@ -508,7 +758,7 @@ int RTLIL::Const::size() const {
 
 bool RTLIL::Const::empty() const {
 	if (is_str())
-		return str_.empty();
+		return str_->first.empty();
 	else {
 		check(is_bits());
 		return bits_.empty();
@@ -523,9 +773,10 @@ void RTLIL::Const::bitvectorize() const {
 
 	bitvectype new_bits;
 
-	new_bits.reserve(str_.size() * 8);
-	for (int i = str_.size() - 1; i >= 0; i--) {
-		unsigned char ch = str_[i];
+	const std::string &str = get_str();
+	new_bits.reserve(str.size() * 8);
+	for (int i = str.size() - 1; i >= 0; i--) {
+		unsigned char ch = str[i];
 		for (int j = 0; j < 8; j++) {
 			new_bits.push_back((ch & 1) != 0 ? State::S1 : State::S0);
 			ch = ch >> 1;
@@ -534,7 +785,7 @@ void RTLIL::Const::bitvectorize() const {
 
 	{
 		// sketchy zone
-		str_.~string();
+		release_str(str_);
 		(void)new ((void*)&bits_) bitvectype(std::move(new_bits));
 		tag = backing_tag::bits;
 	}
@@ -1150,6 +1401,12 @@ std::vector<RTLIL::Module*> RTLIL::Design::selected_whole_modules_warn(bool incl
 	return result;
 }
 
+#ifdef YOSYS_ENABLE_THREADS
+std::atomic<uint64_t> RTLIL::Module::generation_counter{0};
+#else
+uint64_t RTLIL::Module::generation_counter = 0;
+#endif
+
 RTLIL::Module::Module()
 {
 	static unsigned int hashidx_count = 123456789;
@@ -1159,6 +1416,8 @@ RTLIL::Module::Module()
 	design = nullptr;
 	refcount_wires_ = 0;
 	refcount_cells_ = 0;
+	index_ = nullptr;
+	touch();
 
 #ifdef WITH_PYTHON
 	RTLIL::Module::get_all_modules()->insert(std::pair<unsigned int, RTLIL::Module*>(hashidx_, this));
@@ -1167,12 +1426,13 @@ RTLIL::Module::Module()
 
 RTLIL::Module::~Module()
 {
+	delete index_;
 	for (auto &pr : wires_)
-		delete pr.second;
+		free_wire(pr.second);
 	for (auto &pr : memories)
 		delete pr.second;
 	for (auto &pr : cells_)
-		delete pr.second;
+		free_cell(pr.second);
 	for (auto &pr : processes)
 		delete pr.second;
 	for (auto binding : bindings_)
@@ -1203,7 +1463,7 @@ void RTLIL::Module::makeblackbox()
 	memories.clear();
 
 	for (auto it = cells_.begin(); it != cells_.end(); ++it)
-		delete it->second;
+		free_cell(it->second);
 	cells_.clear();
 
 	for (auto it = processes.begin(); it != processes.end(); ++it)
@@ -2398,6 +2658,10 @@ void RTLIL::Module::add(RTLIL::Wire *wire)
 	log_assert(refcount_wires_ == 0);
 	wires_[wire->name] = wire;
 	wire->module = this;
+	if (wire->port_input || wire->port_output)
+		touch();
+	else
+		touch_monitored();
 }
 
 void RTLIL::Module::add(RTLIL::Cell *cell)
@@ -2407,6 +2671,10 @@ void RTLIL::Module::add(RTLIL::Cell *cell)
 	log_assert(refcount_cells_ == 0);
 	cells_[cell->name] = cell;
 	cell->module = this;
+	if (!cell->connections_.empty())
+		touch();
+	else
+		touch_monitored();
 }
 
 void RTLIL::Module::add(RTLIL::Process *process)
@@ -2415,6 +2683,7 @@ void RTLIL::Module::add(RTLIL::Process *process)
 	log_assert(count_id(process->name) == 0);
 	processes[process->name] = process;
 	process->module = this;
+	touch_monitored();
 }
 
 void RTLIL::Module::add(RTLIL::Binding *binding)
@@ -2449,6 +2718,8 @@ void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 		}
 	};
 
+	touch();
+
 	DeleteWireWorker delete_wire_worker;
 	delete_wire_worker.module = this;
 	delete_wire_worker.wires_p = &wires;
@@ -2457,7 +2728,7 @@ void RTLIL::Module::remove(const pool<RTLIL::Wire*> &wires)
 	for (auto &it : wires) {
 		log_assert(wires_.count(it->name) != 0);
 		wires_.erase(it->name);
-		delete it;
+		free_wire(it);
 	}
 }
 
@@ -2469,7 +2740,45 @@ void RTLIL::Module::remove(RTLIL::Cell *cell)
 	log_assert(cells_.count(cell->name) != 0);
 	log_assert(refcount_cells_ == 0);
 	cells_.erase(cell->name);
-	delete cell;
+	free_cell(cell);
+	touch_monitored();
+}
+
+void RTLIL::Module::free_wire(RTLIL::Wire *wire)
+{
+	wire->~Wire();
+	wire_slab_.deallocate(wire);
+}
+
+void RTLIL::Module::free_cell(RTLIL::Cell *cell)
+{
+	cell->~Cell();
+	cell_slab_.deallocate(cell);
+}
+
+void RTLIL::Module::touch_monitored()
+{
+	bool index_valid = index_ != nullptr && index_->generation == generation;
+	touch();
+	if (index_valid)
+		index_->generation = generation;
+}
+
+ModIndex &RTLIL::Module::index()
+{
+	if (index_ == nullptr) {
+		index_ = new ModIndex(this);
+		index_->shared = true;
+		index_->reload_module(false);
+	} else if (index_->auto_reload_module || index_->out_of_date())
+		index_->reload_module();
+	index_->auto_reload_counter = 0;
+	return *index_;
+}
+
+const SigMap &RTLIL::Module::sigmap()
+{
+	return index().sigmap;
 }
 
 void RTLIL::Module::remove(RTLIL::Process *process)
@@ -2477,6 +2786,7 @@ void RTLIL::Module::remove(RTLIL::Process *process)
 	log_assert(processes.count(process->name) != 0);
 	processes.erase(process->name);
 	delete process;
+	touch_monitored();
 }
 
 void RTLIL::Module::rename(RTLIL::Wire *wire, RTLIL::IdString new_name)
@@ -2486,6 +2796,7 @@ void RTLIL::Module::rename(RTLIL::Wire *wire, RTLIL::IdString new_name)
 	wires_.erase(wire->name);
 	wire->name = new_name;
 	add(wire);
+	touch();
 }
 
 void RTLIL::Module::rename(RTLIL::Cell *cell, RTLIL::IdString new_name)
@@ -2495,6 +2806,7 @@ void RTLIL::Module::rename(RTLIL::Cell *cell, RTLIL::IdString new_name)
 	cells_.erase(cell->name);
 	cell->name = new_name;
 	add(cell);
+	touch();
 }
 
 void RTLIL::Module::rename(RTLIL::IdString old_name, RTLIL::IdString new_name)
@@ -2521,6 +2833,7 @@ void RTLIL::Module::swap_names(RTLIL::Wire *w1, RTLIL::Wire *w2)
 
 	wires_[w1->name] = w1;
 	wires_[w2->name] = w2;
+	touch();
 }
 
 void RTLIL::Module::swap_names(RTLIL::Cell *c1, RTLIL::Cell *c2)
@@ -2536,6 +2849,7 @@ void RTLIL::Module::swap_names(RTLIL::Cell *c1, RTLIL::Cell *c2)
 
 	cells_[c1->name] = c1;
 	cells_[c2->name] = c2;
+	touch();
 }
 
 RTLIL::IdString RTLIL::Module::uniquify(RTLIL::IdString name)
@@ -2574,6 +2888,8 @@ static bool fixup_ports_compare(const RTLIL::Wire *a, const RTLIL::Wire *b)
 
 void RTLIL::Module::connect(const RTLIL::SigSig &conn)
 {
+	touch_monitored();
+
 	for (auto mon : monitors)
 		mon->notify_connect(this, conn);
 
@@ -2610,6 +2926,8 @@ void RTLIL::Module::connect(const RTLIL::SigSpec &lhs, const RTLIL::SigSpec &rhs
 
 void RTLIL::Module::new_connections(const std::vector<RTLIL::SigSig> &new_conn)
 {
+	touch_monitored();
+
 	for (auto mon : monitors)
 		mon->notify_connect(this, new_conn);
 
@@ -2634,6 +2952,8 @@ const std::vector<RTLIL::SigSig> &RTLIL::Module::connections() const
 
 void RTLIL::Module::fixup_ports()
 {
+	touch();
+
 	std::vector<RTLIL::Wire*> all_ports;
 
 	for (auto &w : wires_)
@@ -2653,7 +2973,7 @@ void RTLIL::Module::fixup_ports()
 
 RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, int width)
 {
-	RTLIL::Wire *wire = new RTLIL::Wire;
+	RTLIL::Wire *wire = new (wire_slab_.allocate()) RTLIL::Wire;
 	wire->name = name;
 	wire->width = width;
 	add(wire);
@@ -2671,12 +2991,14 @@ RTLIL::Wire *RTLIL::Module::addWire(RTLIL::IdString name, const RTLIL::Wire *oth
 	wire->upto = other->upto;
 	wire->is_signed = other->is_signed;
 	wire->attributes = other->attributes;
+	if (wire->port_input || wire->port_output)
+		touch();
 	return wire;
 }
 
 RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, RTLIL::IdString type)
 {
-	RTLIL::Cell *cell = new RTLIL::Cell;
+	RTLIL::Cell *cell = new (cell_slab_.allocate()) RTLIL::Cell;
 	cell->name = name;
 	cell->type = type;
 	add(cell);
@@ -2689,6 +3011,7 @@ RTLIL::Cell *RTLIL::Module::addCell(RTLIL::IdString name, const RTLIL::Cell *oth
 	cell->connections_ = other->connections_;
 	cell->parameters = other->parameters;
 	cell->attributes = other->attributes;
+	touch();
 	return cell;
 }
 
@@ -2701,6 +3024,7 @@ RTLIL::Memory *RTLIL::Module::addMemory(RTLIL::IdString name, const RTLIL::Memor
 	mem->size = other->size;
 	mem->attributes = other->attributes;
 	memories[mem->name] = mem;
+	touch_monitored();
 	return mem;
 }
 
@@ -3698,11 +4022,32 @@ RTLIL::SigSpec RTLIL::Module::FutureFF(RTLIL::IdString name, const RTLIL::SigSpe
 	return sig;
 }
 
+// The members of a module may be created by ModulePass worker threads.
+#ifdef YOSYS_ENABLE_THREADS
+typedef std::atomic<unsigned int> hashidx_counter_t;
+
+static unsigned int next_hashidx(hashidx_counter_t &count)
+{
+	unsigned int old = count.load(std::memory_order_relaxed), next;
+	do
+		next = mkhash_xorshift(old);
+	while (!count.compare_exchange_weak(old, next, std::memory_order_relaxed));
+	return next;
+}
+#else
+typedef unsigned int hashidx_counter_t;
+
+static unsigned int next_hashidx(hashidx_counter_t &count)
+{
+	count = mkhash_xorshift(count);
+	return count;
+}
+#endif
+
 RTLIL::Wire::Wire()
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static hashidx_counter_t hashidx_count{123456789};
+	hashidx_ = next_hashidx(hashidx_count);
 
 	module = nullptr;
 	width = 1;
@@ -3735,9 +4080,8 @@ std::map<unsigned int, RTLIL::Wire*> *RTLIL::Wire::get_all_wires(void)
 
 RTLIL::Memory::Memory()
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static hashidx_counter_t hashidx_count{123456789};
+	hashidx_ = next_hashidx(hashidx_count);
 
 	width = 1;
 	start_offset = 0;
@@ -3749,16 +4093,14 @@ RTLIL::Memory::Memory()
 
 RTLIL::Process::Process() : module(nullptr)
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static hashidx_counter_t hashidx_count{123456789};
+	hashidx_ = next_hashidx(hashidx_count);
 }
 
 RTLIL::Cell::Cell() : module(nullptr)
 {
-	static unsigned int hashidx_count = 123456789;
-	hashidx_count = mkhash_xorshift(hashidx_count);
-	hashidx_ = hashidx_count;
+	static hashidx_counter_t hashidx_count{123456789};
+	hashidx_ = next_hashidx(hashidx_count);
 
 	// log("#memtrace# %p\n", this);
 	memhasher();
@@ -3795,6 +4137,8 @@ void RTLIL::Cell::unsetPort(const RTLIL::IdString& portname)
 
 	if (conn_it != connections_.end())
 	{
+		module->touch_monitored();
+
 		for (auto mon : module->monitors)
 			mon->notify_connect(this, conn_it->first, conn_it->second, signal);
 
@@ -3922,6 +4266,8 @@ void RTLIL::Cell::setPort(const RTLIL::IdString& portname, RTLIL::SigSpec signal
 	if (!r.second && conn_it->second == signal)
 		return;
 
+	module->touch_monitored();
+
 	for (auto mon : module->monitors)
 		mon->notify_connect(this, conn_it->first, conn_it->second, signal);
 
@@ -4022,11 +4368,15 @@ bool RTLIL::Cell::hasParam(const RTLIL::IdString& paramname) const
 void RTLIL::Cell::unsetParam(const RTLIL::IdString& paramname)
 {
 	parameters.erase(paramname);
+	if (module)
+		module->touch_monitored();
 }
 
 void RTLIL::Cell::setParam(const RTLIL::IdString& paramname, RTLIL::Const value)
 {
 	parameters[paramname] = std::move(value);
+	if (module)
+		module->touch_monitored();
 }
 
 const RTLIL::Const &RTLIL::Cell::getParam(const RTLIL::IdString& paramname) const
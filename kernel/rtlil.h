@@ -22,9 +22,14 @@
 
 #include "kernel/yosys_common.h"
 #include "kernel/yosys.h"
+#include "kernel/slab.h"
 
 YOSYS_NAMESPACE_BEGIN
 
+// Defined in sigtools.h and modtools.h.
+struct SigMap;
+struct ModIndex;
+
 namespace RTLIL
 {
 	enum State : unsigned char {
@@ -96,6 +101,89 @@ struct RTLIL::IdString
 		~destruct_guard_t() { destruct_guard_ok = false; }
 	} destruct_guard;
 
+#ifdef YOSYS_ENABLE_THREADS
+	// Variant of the cache that is safe for concurrent use. The entries live in chunks
+	// that are never moved, so that c_str() needs no lock, and their refcounts are
+	// atomic. The name index is split into shards guarded by their own mutex. While
+	// yosys_threads_running is set, entries are not released when their refcount drops
+	// to zero, but by the next checkpoint(), under the lock of their shard, so that a
+	// concurrent lookup by name may still revive them. Released indices are reused
+	// through per-thread free lists.
+
+	struct id_entry {
+		std::atomic<char*> str;
+		std::atomic<int> refcount;
+	};
+
+	struct id_shard {
+		std::mutex mutex;
+		dict<char*, int> index;
+	};
+
+	static constexpr int id_chunk_bits = 12;
+	static constexpr int id_max_chunks = 1 << 18;
+	static constexpr int id_num_shards = 64;
+
+	static id_entry global_id_chunk0_[1 << id_chunk_bits];
+	static std::atomic<id_entry*> global_id_chunks_[id_max_chunks];
+	static std::atomic<int> global_id_count_;
+	static id_shard global_id_shards_[id_num_shards];
+
+	static inline id_entry &get_entry(int idx)
+	{
+		id_entry *chunk = global_id_chunks_[idx >> id_chunk_bits].load(std::memory_order_acquire);
+		return chunk[idx & ((1 << id_chunk_bits) - 1)];
+	}
+
+	static inline id_shard &get_shard(const char *p)
+	{
+		// a cheap hash of the tail, where the names created in bulk differ
+		size_t len = strlen(p);
+		unsigned int h = len;
+		for (size_t i = len > 4 ? len - 4 : 0; i < len; i++)
+			h = h * 33 + (unsigned char)p[i];
+		return global_id_shards_[h % id_num_shards];
+	}
+
+	static inline void xtrace_db_dump() { }
+
+	static void checkpoint();
+
+	static inline int get_reference(int idx)
+	{
+		if (idx) {
+			std::atomic<int> &refcount = get_entry(idx).refcount;
+			if (yosys_threads_running)
+				refcount.fetch_add(1, std::memory_order_relaxed);
+			else
+				refcount.store(refcount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+		return idx;
+	}
+
+	static int get_reference(const char *p);
+
+	static inline void put_reference(int idx)
+	{
+		// see the single-threaded variant below
+		if (!destruct_guard_ok || !idx)
+			return;
+
+		std::atomic<int> &refcount = get_entry(idx).refcount;
+		if (yosys_threads_running) {
+			if (refcount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+				defer_free_reference(idx);
+		} else {
+			int count = refcount.load(std::memory_order_relaxed) - 1;
+			refcount.store(count, std::memory_order_relaxed);
+			if (count == 0)
+				free_reference(idx);
+		}
+	}
+
+	static void defer_free_reference(int idx);
+	static void free_reference(int idx);
+#else
 	static std::vector<char*> global_id_storage_;
 	static dict<char*, int> global_id_index_;
 #ifndef YOSYS_NO_IDS_REFCNT
@@ -262,6 +350,10 @@ struct RTLIL::IdString
 #else
 	static inline void put_reference(int) { }
 #endif
+#endif
+
+	// the number of IdStrings currently in use, for profiling
+	static int live_count();
 
 	// the actual IdString object is just is a single int
 
@@ -290,11 +382,15 @@ struct RTLIL::IdString
 	}
 
 	inline const char *c_str() const {
+#ifdef YOSYS_ENABLE_THREADS
+		return get_entry(index_).str.load(std::memory_order_relaxed);
+#else
 		return global_id_storage_.at(index_);
+#endif
 	}
 
 	inline std::string str() const {
-		return std::string(global_id_storage_.at(index_));
+		return std::string(c_str());
 	}
 
 	inline bool operator<(const IdString &rhs) const {
@@ -693,20 +789,34 @@ private:
 	enum class backing_tag: bool { bits, string };
 	// Do not access the union or tag even in Const methods unless necessary
 	mutable backing_tag tag;
+	// String-backed values are interned in a global pool and refer to their pool
+	// entry, which holds the string and a refcount. Attribute values such as `src`
+	// are copied onto every cell derived from a source cell, and all these copies
+	// share a single string.
+#ifdef YOSYS_ENABLE_THREADS
+	using str_refcount = std::atomic<int>;
+#else
+	using str_refcount = int;
+#endif
+	using str_entry = std::pair<const std::string, str_refcount>;
 	union {
 		mutable bitvectype bits_;
-		mutable std::string str_;
+		mutable str_entry *str_;
 	};
 
+	static std::unordered_map<std::string, str_refcount> &str_pool();
+	static str_entry *intern_str(const std::string &str);
+	static void release_str(str_entry *entry);
+
 	// Use these private utilities instead
 	bool is_bits() const { return tag == backing_tag::bits; }
 	bool is_str() const { return tag == backing_tag::string; }
 
 	bitvectype* get_if_bits() const { return is_bits() ? &bits_ : NULL; }
-	std::string* get_if_str() const { return is_str() ? &str_ : NULL; }
+	const std::string* get_if_str() const { return is_str() ? &str_->first : NULL; }
 
 	bitvectype& get_bits() const;
-	std::string& get_str() const;
+	const std::string& get_str() const;
 public:
 	Const() : flags(RTLIL::CONST_FLAG_NONE), tag(backing_tag::bits), bits_(std::vector<RTLIL::State>()) {}
 	Const(const std::string &str);
@@ -1292,6 +1402,15 @@ protected:
 	void add(RTLIL::Cell *cell);
 	void add(RTLIL::Process *process);
 
+	// wires and cells are allocated from per-module slabs, released with the module
+	SlabAllocator<RTLIL::Wire> wire_slab_;
+	SlabAllocator<RTLIL::Cell> cell_slab_;
+	void free_wire(RTLIL::Wire *wire);
+	void free_cell(RTLIL::Cell *cell);
+
+	// shared index, created on first use and kept until the module is destroyed
+	ModIndex *index_;
+
 public:
 	RTLIL::Design *design;
 	pool<RTLIL::Monitor*> monitors;
@@ -1299,6 +1418,21 @@ public:
 	int refcount_wires_;
 	int refcount_cells_;
 
+	// Stamped from a global counter by the mutators of the module and of its cells,
+	// so that fixpoint loops such as `opt` can tell which modules have changed since
+	// a given point. Direct writes to members (e.g. cell->type) are not tracked: a
+	// pass making them calls touch() on the modules it changed.
+	uint64_t generation;
+#ifdef YOSYS_ENABLE_THREADS
+	static std::atomic<uint64_t> generation_counter;
+#else
+	static uint64_t generation_counter;
+#endif
+	void touch() { generation = ++generation_counter; }
+	// Like touch(), for the changes that are reported to the monitors or that do not
+	// affect the shared index, which stays valid
+	void touch_monitored();
+
 	dict<RTLIL::IdString, RTLIL::Wire*> wires_;
 	dict<RTLIL::IdString, RTLIL::Cell*> cells_;
 
@@ -1344,6 +1478,16 @@ public:
 	void cloneInto(RTLIL::Module *new_mod) const;
 	virtual RTLIL::Module *clone() const;
 
+	// A ModIndex of the module, with its SigMap, that is shared by all passes instead
+	// of being rebuilt by each of them. It follows the changes made through setPort(),
+	// connect() and new_connections(), and is rebuilt in place on its next use after
+	// a change that bypasses the monitors, i.e. one that calls touch() (removing or
+	// renaming wires and cells, rewrite_sigspecs, fixup_ports). A pass that writes
+	// connections_, port flags or names directly must call touch(). A pass that adds
+	// its own connections to the SigMap must use a copy.
+	ModIndex &index();
+	const SigMap &sigmap();
+
 	bool has_memories() const;
 	bool has_processes() const;
 
@@ -1885,6 +2029,7 @@ inline RTLIL::SigBit::SigBit(const RTLIL::SigSpec &sig) {
 template<typename T>
 void RTLIL::Module::rewrite_sigspecs(T &functor)
 {
+	touch();
 	for (auto &it : cells_)
 		it.second->rewrite_sigspecs(functor);
 	for (auto &it : processes)
@@ -1898,6 +2043,7 @@ void RTLIL::Module::rewrite_sigspecs(T &functor)
 template<typename T>
 void RTLIL::Module::rewrite_sigspecs2(T &functor)
 {
+	touch();
 	for (auto &it : cells_)
 		it.second->rewrite_sigspecs2(functor);
 	for (auto &it : processes)
@@ -0,0 +1,97 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2012  Claire Xenia Wolf <claire@yosyshq.com>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "kernel/yosys_common.h"
+
+// Per-object allocation is kept for sanitizer builds, so that use-after-free
+// and leaks of individual objects are still reported.
+#if !defined(YOSYS_DISABLE_SLAB) && defined(__SANITIZE_ADDRESS__)
+#  define YOSYS_DISABLE_SLAB
+#endif
+#if !defined(YOSYS_DISABLE_SLAB) && defined(__has_feature)
+#  if __has_feature(address_sanitizer) || __has_feature(memory_sanitizer)
+#    define YOSYS_DISABLE_SLAB
+#  endif
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+// Storage for objects of type T, carved out of slabs of increasing size.
+// Freed storage is kept in a free list for reuse, and all the slabs are
+// released at once when the allocator is destroyed. The allocator only
+// manages the memory: construction and destruction of the objects is left
+// to the caller, and all the objects must be destroyed before the allocator.
+template<typename T>
+class SlabAllocator
+{
+	union Slot {
+		Slot *next_free;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	static constexpr size_t min_slab_size = 16;
+	static constexpr size_t max_slab_size = 4096;
+
+	std::vector<std::unique_ptr<Slot[]>> slabs;
+	Slot *free_list = nullptr;
+	size_t slab_used = 0;
+	size_t slab_size = 0;
+
+public:
+	SlabAllocator() { }
+	SlabAllocator(const SlabAllocator&) = delete;
+	SlabAllocator &operator=(const SlabAllocator&) = delete;
+
+	void *allocate()
+	{
+#ifdef YOSYS_DISABLE_SLAB
+		return ::operator new(sizeof(T));
+#else
+		if (free_list != nullptr) {
+			Slot *slot = free_list;
+			free_list = slot->next_free;
+			return slot->storage;
+		}
+		if (slab_used == slab_size) {
+			slab_size = slabs.empty() ? min_slab_size : std::min(2 * slab_size, max_slab_size);
+			slabs.emplace_back(new Slot[slab_size]);
+			slab_used = 0;
+		}
+		return slabs.back()[slab_used++].storage;
+#endif
+	}
+
+	void deallocate(void *ptr)
+	{
+#ifdef YOSYS_DISABLE_SLAB
+		::operator delete(ptr);
+#else
+		Slot *slot = reinterpret_cast<Slot*>(ptr);
+		slot->next_free = free_list;
+		free_list = slot;
+#endif
+	}
+};
+
+YOSYS_NAMESPACE_END
+
+#endif
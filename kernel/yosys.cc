@@ -79,8 +79,12 @@
 
 YOSYS_NAMESPACE_BEGIN
 
-int autoidx = 1;
+YS_THREAD_LOCAL int autoidx = 1;
 int yosys_xtrace = 0;
+int yosys_jobs = 1;
+#ifdef YOSYS_ENABLE_THREADS
+bool yosys_threads_running = false;
+#endif
 RTLIL::Design *yosys_design = NULL;
 CellTypes yosys_celltypes;
 
@@ -662,6 +666,69 @@ RTLIL::IdString new_id_suffix(std::string file, int line, std::string func, std:
 	return stringf("$auto$%s:%d:%s$%s$%d", file.c_str(), line, func.c_str(), suffix.c_str(), autoidx++);
 }
 
+bool yosys_compact_auto_ids = false;
+
+// With compact auto IDs, the call site of each ID, indexed by autoidx.
+static dict<int, const NewIdSite*> compact_auto_id_sites;
+
+NewIdSite::NewIdSite(const char *file, int line, const char *func) : file(file), line(line), func(func)
+{
+	std::string file_str = file, func_str = func;
+#ifdef _WIN32
+	size_t pos = file_str.find_last_of("/\\");
+#else
+	size_t pos = file_str.find_last_of('/');
+#endif
+	if (pos != std::string::npos)
+		file_str = file_str.substr(pos+1);
+
+	pos = func_str.find_last_of(':');
+	if (pos != std::string::npos)
+		func_str = func_str.substr(pos+1);
+
+	prefix = stringf("$auto$%s:%d:%s$", file_str.c_str(), line, func_str.c_str());
+}
+
+RTLIL::IdString new_id_at(const NewIdSite &site)
+{
+	if (yosys_compact_auto_ids) {
+		compact_auto_id_sites[autoidx] = &site;
+		return "$auto$$" + std::to_string(autoidx++);
+	}
+	return site.prefix + std::to_string(autoidx++);
+}
+
+RTLIL::IdString new_id_suffix_at(const NewIdSite &site, const std::string &suffix)
+{
+	if (yosys_compact_auto_ids) {
+		compact_auto_id_sites[autoidx] = &site;
+		return "$auto$$" + suffix + "$" + std::to_string(autoidx++);
+	}
+	return site.prefix + suffix + "$" + std::to_string(autoidx++);
+}
+
+// Returns the name the given compact auto ID would have had without compact auto IDs,
+// or the ID itself if it is not a compact auto ID. Compact auto IDs start with "$auto$$",
+// which a full "$auto$<file>:<line>:<func>$" prefix never does.
+std::string new_id_origin(const RTLIL::IdString &id)
+{
+	std::string str = id.str();
+	if (str.compare(0, 7, "$auto$$") != 0)
+		return str;
+
+	size_t pos = str.find_last_of('$');
+	std::string idx_str = str.substr(pos+1);
+	if (idx_str.empty() || idx_str.find_first_not_of("0123456789") != std::string::npos)
+		return str;
+	int idx = atoi(idx_str.c_str());
+	std::string suffix = pos > 6 ? str.substr(7, pos - 6) : std::string();
+
+	auto it = compact_auto_id_sites.find(idx);
+	if (it == compact_auto_id_sites.end())
+		return str;
+	return it->second->prefix + suffix + idx_str;
+}
+
 RTLIL::Design *yosys_get_design()
 {
 	return yosys_design;
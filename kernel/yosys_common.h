@@ -37,6 +37,12 @@
 #include <cmath>
 #include <cstddef>
 
+#ifdef YOSYS_ENABLE_THREADS
+#include <atomic>
+#include <mutex>
+#include <thread>
+#endif
+
 #include <sstream>
 #include <fstream>
 #include <istream>
@@ -128,6 +134,13 @@
 #  error "C++17 or later compatible compiler is required"
 #endif
 
+// State that ModulePass worker threads keep for themselves, such as autoidx.
+#ifdef YOSYS_ENABLE_THREADS
+#  define YS_THREAD_LOCAL thread_local
+#else
+#  define YS_THREAD_LOCAL
+#endif
+
 
 YOSYS_NAMESPACE_BEGIN
 
@@ -322,16 +335,47 @@ std::string escape_filename_spaces(const std::string& filename);
 template<typename T> int GetSize(const T &obj) { return obj.size(); }
 inline int GetSize(RTLIL::Wire *wire);
 
-extern int autoidx;
+extern YS_THREAD_LOCAL int autoidx;
 extern int yosys_xtrace;
 
+// The number of threads used by ModulePass, set with `yosys -j` or YOSYS_JOBS.
+extern int yosys_jobs;
+
+#ifdef YOSYS_ENABLE_THREADS
+// Set while worker threads may use the kernel data structures concurrently. Only
+// changed by the main thread while no worker thread is running, so that the
+// single-threaded code paths can skip the locks and atomic read-modify-writes.
+extern bool yosys_threads_running;
+#endif
+
 RTLIL::IdString new_id(std::string file, int line, std::string func);
 RTLIL::IdString new_id_suffix(std::string file, int line, std::string func, std::string suffix);
 
+// The source location of a NEW_ID call. Each call site gets one statically allocated
+// instance, so that the "$auto$file:line:func$" prefix is only formatted once.
+struct NewIdSite {
+	const char *file;
+	int line;
+	const char *func;
+	std::string prefix;
+	NewIdSite(const char *file, int line, const char *func);
+};
+
+// If set, NEW_ID creates compact "$auto$$<idx>" names and only records the call site
+// in a side table, which new_id_origin() consults.
+extern bool yosys_compact_auto_ids;
+
+RTLIL::IdString new_id_at(const NewIdSite &site);
+RTLIL::IdString new_id_suffix_at(const NewIdSite &site, const std::string &suffix);
+std::string new_id_origin(const RTLIL::IdString &id);
+
+#define NEW_ID_SITE \
+	([](const char *func) -> const YOSYS_NAMESPACE_PREFIX NewIdSite& { \
+		static const YOSYS_NAMESPACE_PREFIX NewIdSite site(__FILE__, __LINE__, func); return site; })(__FUNCTION__)
 #define NEW_ID \
-	YOSYS_NAMESPACE_PREFIX new_id(__FILE__, __LINE__, __FUNCTION__)
+	YOSYS_NAMESPACE_PREFIX new_id_at(NEW_ID_SITE)
 #define NEW_ID_SUFFIX(suffix) \
-	YOSYS_NAMESPACE_PREFIX new_id_suffix(__FILE__, __LINE__, __FUNCTION__, suffix)
+	YOSYS_NAMESPACE_PREFIX new_id_suffix_at(NEW_ID_SITE, suffix)
 
 // Create a statically allocated IdString object, using for example ID::A or ID($add).
 //
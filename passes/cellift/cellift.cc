@@ -19,6 +19,7 @@
 
 // For all new cells, add src=cell->get_src_attribute()
 
+#include "kernel/celltypes.h"
 #include "kernel/log.h"
 #include "kernel/register.h"
 #include "kernel/rtlil.h"
@@ -29,6 +30,10 @@ USING_YOSYS_NAMESPACE
 
 extern bool is_signal_excluded(std::vector<string> *excluded_signals, string signal_name);
 extern std::string get_wire_taint_idstring(RTLIL::IdString id_string, unsigned int taint_id);
+extern RTLIL::Wire *get_wire_taint(RTLIL::Module *module, RTLIL::Wire *wire, unsigned int taint_id);
+extern bool compact_taint_names;
+extern dict<std::pair<RTLIL::Wire *, unsigned int>, RTLIL::Wire *> compact_taint_wires;
+extern void reset_compact_taint_wires();
 extern std::vector<RTLIL::SigSpec> get_corresponding_taint_signals(RTLIL::Module *module, std::vector<string> *excluded_signals,
 								   const RTLIL::SigSpec &sig, unsigned int num_taints);
 
@@ -107,10 +112,151 @@ struct CellIFTWorker {
 	bool opt_pmux_use_large_cells = false;	     // pmux instrumentation performance.
 	unsigned int num_taints = 1;
 	std::vector<string> *excluded_signals;
+	FILE *name_map_file = nullptr; // Where to write the compact taint names, if any.
 
 	RTLIL::Module *module = nullptr;
 	const RTLIL::IdString cellift_attribute_name = ID(cellift);
 	const RTLIL::IdString cellift_noinstrument_attribute_name = ID(cellift_noinstrument);
+	const RTLIL::IdString cellift_declassify_attribute_name = ID(cellift_declassify);
+
+	// Cells whose output taint may reach a taint sink. Only used if the module has declassified wires.
+	bool has_declassified_wires = false;
+	pool<RTLIL::Cell *> taint_live_cells;
+
+	bool is_declassified(const RTLIL::SigBit &bit) { return bit.wire != nullptr && bit.wire->get_bool_attribute(cellift_declassify_attribute_name); }
+
+	// Walks backwards from the taint sinks (output ports, state elements and submodule instances) without crossing declassified wires,
+	// and records the cells encountered on the way. The shadow logic of the other cells could only drive declassified taints.
+	void compute_taint_liveness()
+	{
+		dict<RTLIL::SigBit, std::vector<RTLIL::Cell *>> bit_drivers;
+		dict<RTLIL::SigBit, std::vector<RTLIL::SigBit>> bit_connections;
+		pool<RTLIL::SigBit> live_bits;
+		std::vector<RTLIL::SigBit> worklist;
+
+		auto mark_live = [&](const RTLIL::SigSpec &sig) {
+			for (auto bit : sig)
+				if (bit.wire != nullptr && !is_declassified(bit) && live_bits.insert(bit).second)
+					worklist.push_back(bit);
+		};
+
+		for (auto &conn : module->connections())
+			for (int i = 0; i < GetSize(conn.first); i++)
+				bit_connections[conn.first[i]].push_back(conn.second[i]);
+
+		for (auto cell : module->cells()) {
+			bool is_sink = !yosys_celltypes.cell_known(cell->type) || RTLIL::builtin_ff_cell_types().count(cell->type);
+			if (is_sink)
+				taint_live_cells.insert(cell);
+			for (auto &conn : cell->connections()) {
+				if (cell->output(conn.first))
+					for (auto bit : conn.second)
+						if (bit.wire != nullptr)
+							bit_drivers[bit].push_back(cell);
+				if (is_sink && cell->input(conn.first))
+					mark_live(conn.second);
+			}
+		}
+
+		for (auto wire : module->wires())
+			if (wire->port_output || wire->get_bool_attribute(ID::keep))
+				mark_live(wire);
+
+		while (!worklist.empty()) {
+			RTLIL::SigBit bit = worklist.back();
+			worklist.pop_back();
+
+			if (bit_connections.count(bit))
+				for (auto &driver_bit : bit_connections.at(bit))
+					mark_live(driver_bit);
+			if (bit_drivers.count(bit))
+				for (auto cell : bit_drivers.at(bit))
+					if (taint_live_cells.insert(cell).second)
+						for (auto &conn : cell->connections())
+							if (cell->input(conn.first))
+								mark_live(conn.second);
+		}
+	}
+
+	// Forces the taint of the declassified wires to zero. Internal and output taint wires are tied to zero and their drivers are moved
+	// to a dangling wire, so that opt_clean removes the upstream shadow logic. Taint input ports are replaced by zero in their readers.
+	void declassify_taint_wires()
+	{
+		std::vector<RTLIL::Wire *> declassified_wires;
+		for (auto wire : module->wires())
+			if (wire->get_bool_attribute(cellift_declassify_attribute_name) && !wire->get_bool_attribute(cellift_attribute_name))
+				declassified_wires.push_back(wire);
+
+		dict<RTLIL::SigBit, RTLIL::SigBit> driver_rules, reader_rules;
+		std::vector<RTLIL::Wire *> tied_taint_wires;
+		for (auto wire : declassified_wires) {
+			for (unsigned int taint_id = 0; taint_id < num_taints; taint_id++) {
+				RTLIL::Wire *taint_wire = get_wire_taint(module, wire, taint_id);
+				if (taint_wire == nullptr)
+					continue;
+				if (opt_verbose)
+					log("    Declassifying %s.\n", taint_wire->name.c_str());
+
+				if (taint_wire->port_input) {
+					for (int i = 0; i < taint_wire->width; i++)
+						reader_rules[RTLIL::SigBit(taint_wire, i)] = RTLIL::State::S0;
+				} else {
+					RTLIL::Wire *dangling_wire = module->addWire(NEW_ID, taint_wire->width);
+					for (int i = 0; i < taint_wire->width; i++)
+						driver_rules[RTLIL::SigBit(taint_wire, i)] = RTLIL::SigBit(dangling_wire, i);
+					tied_taint_wires.push_back(taint_wire);
+				}
+			}
+		}
+
+		for (auto cell : module->cells()) {
+			dict<RTLIL::IdString, RTLIL::SigSpec> ports = cell->connections();
+			for (auto &it : ports) {
+				RTLIL::SigSpec sig = it.second;
+				if (cell->output(it.first))
+					sig.replace(driver_rules);
+				if (cell->input(it.first))
+					sig.replace(reader_rules);
+				if (sig != it.second)
+					cell->setPort(it.first, sig);
+			}
+		}
+
+		std::vector<RTLIL::SigSig> new_connections(module->connections());
+		for (auto &conn : new_connections) {
+			conn.first.replace(driver_rules);
+			conn.second.replace(reader_rules);
+		}
+		module->new_connections(new_connections);
+
+		for (auto taint_wire : tied_taint_wires)
+			module->connect(taint_wire, RTLIL::SigSpec(RTLIL::State::S0, taint_wire->width));
+	}
+
+	// The Q nets of the taint flip-flops get back their readable names, as they are the ones inspected in simulation. The compact
+	// names of the other taint wires are written to the name map file.
+	void finalize_compact_taint_names()
+	{
+		dict<RTLIL::Wire *, std::string> readable_names;
+		for (auto &it : compact_taint_wires)
+			readable_names[it.second] = get_wire_taint_idstring(it.first.first->name, it.first.second);
+
+		for (auto cell : module->cells()) {
+			if (!cell->has_attribute(ID(taint_ff)) || !cell->hasPort(ID::Q))
+				continue;
+			for (auto &chunk_it : cell->getPort(ID::Q).chunks()) {
+				if (!chunk_it.is_wire() || !readable_names.count(chunk_it.wire))
+					continue;
+				if (module->wire(readable_names.at(chunk_it.wire)) == nullptr)
+					module->rename(chunk_it.wire, readable_names.at(chunk_it.wire));
+				readable_names.erase(chunk_it.wire);
+			}
+		}
+
+		if (name_map_file != nullptr)
+			for (auto &it : readable_names)
+				fprintf(name_map_file, "%s %s %s\n", log_id(module), it.first->name.c_str(), it.second.c_str());
+	}
 
 	void create_cellift_logic()
 	{
@@ -130,12 +276,21 @@ struct CellIFTWorker {
 
 		std::vector<RTLIL::SigSig> connections(module->connections());
 
+		for (auto wire : module->wires())
+			if (wire->get_bool_attribute(cellift_declassify_attribute_name))
+				has_declassified_wires = true;
+		if (has_declassified_wires)
+			compute_taint_liveness();
+
 		// Add the new taint I/O connections.
 		pool<std::pair<RTLIL::IdString, int>> in_out_wires_to_add;
 		pool<std::pair<RTLIL::IdString, int>> input_wires_to_add;
 		pool<std::pair<RTLIL::IdString, int>> output_wires_to_add;
 
 		// First, create the input and output wires for the taints if they are not excluded.
+		if (compact_taint_names)
+			reset_compact_taint_wires();
+
 		for (auto &wire_it : module->wires_) {
 			// in/out ports
 			if (wire_it.second->port_input && wire_it.second->port_output && !is_signal_excluded(excluded_signals, wire_it.first.str())) {
@@ -201,6 +356,13 @@ struct CellIFTWorker {
 			// By default, do not remove the original cell but supplement it with IFT logic.
 			keep_current_cell = true;
 
+			// The taint of this cell can only reach declassified wires, so its shadow logic would be thrown away.
+			if (has_declassified_wires && !taint_live_cells.count(cell) && !cell->type.in(ID($print))) {
+				if (opt_verbose)
+					log("    Skipping %s cell (%s), its taint is declassified.\n", cell->type.c_str(), cell->name.c_str());
+				continue;
+			}
+
 			////
 			// Latches
 			////
@@ -520,6 +682,12 @@ struct CellIFTWorker {
 				module->connect(first[taint_id], second[taint_id]);
 		}
 
+		if (has_declassified_wires)
+			declassify_taint_wires();
+
+		if (compact_taint_names)
+			finalize_compact_taint_names();
+
 		module->fixup_ports();
 		module->set_bool_attribute(cellift_attribute_name, true);
 	}
@@ -528,7 +696,7 @@ struct CellIFTWorker {
 	CellIFTWorker(RTLIL::Module *_module, bool _opt_verbose, bool _opt_rtlift, bool _opt_conjunctive_gates,
 		      pool<string> _opt_conjunctive_cells_pool, bool _opt_precise_shiftx, bool _opt_imprecise_shl_sshl, bool _opt_imprecise_shr_sshr,
 		      bool _opt_pmux_use_large_cells, int unsigned _num_taints,
-		      std::vector<string> *_excluded_signals)
+		      std::vector<string> *_excluded_signals, FILE *_name_map_file)
 	{
 		module = _module;
 		opt_verbose = _opt_verbose;
@@ -541,6 +709,7 @@ struct CellIFTWorker {
 		opt_pmux_use_large_cells = _opt_pmux_use_large_cells;
 		num_taints = _num_taints;
 		excluded_signals = _excluded_signals;
+		name_map_file = _name_map_file;
 
 		create_cellift_logic();
 	}
@@ -581,6 +750,22 @@ struct CelliftPass : public Pass {
 		log("    The list must be comma-separated and must contain no space.\n");
 		log("    Example: -exclude-signals clk_i,rst_ni\n");
 		log("\n");
+		log("  -declassify <selection>\n");
+		log("    Force the taint of the selected wires to zero, as if they carried the\n");
+		log("    'cellift_declassify' attribute. The shadow logic whose taint only reaches\n");
+		log("    declassified wires is not generated. State elements, output ports and\n");
+		log("    submodule instances are always considered as taint sinks.\n");
+		log("    This option can be given multiple times.\n");
+		log("\n");
+		log("  -compact-names\n");
+		log("    Give compact private names ($t<N>) to the internal taint wires instead of\n");
+		log("    public names derived from the original wire names. Taint ports and the Q nets\n");
+		log("    of the taint flip-flops keep their readable names.\n");
+		log("\n");
+		log("  -name-map <file>\n");
+		log("    With -compact-names, write the readable name of each compact taint wire to\n");
+		log("    <file>, one '<module> <compact name> <readable name>' line per wire.\n");
+		log("\n");
 		log("  -precise-shiftx\n");
 		log("    Implement precise IFT logic for the shift and shiftx cells. This is expensive.\n");
 		log("\n");
@@ -631,6 +816,9 @@ struct CelliftPass : public Pass {
 		bool opt_pmux_use_large_cells = false;
 		string opt_excluded_signals_csv;
 		std::vector<string> opt_excluded_signals;
+		std::vector<string> opt_declassify_selections;
+		bool opt_compact_names = false;
+		string opt_name_map_filename;
 
 		int unsigned num_taints = 1;
 		log_header(design, "Executing CellIFT pass.\n");
@@ -657,6 +845,18 @@ struct CelliftPass : public Pass {
 				opt_excluded_signals_csv = args[++argidx];
 				continue;
 			}
+			if (args[argidx] == "-declassify" && argidx + 1 < args.size()) {
+				opt_declassify_selections.push_back(args[++argidx]);
+				continue;
+			}
+			if (args[argidx] == "-compact-names") {
+				opt_compact_names = true;
+				continue;
+			}
+			if (args[argidx] == "-name-map" && argidx + 1 < args.size()) {
+				opt_name_map_filename = args[++argidx];
+				continue;
+			}
 			if (args[argidx] == "-precise-shiftx") {
 				opt_precise_shiftx = true;
 				continue;
@@ -814,13 +1014,37 @@ struct CelliftPass : public Pass {
 		} else if (opt_verbose)
 			log("No -exclude-signals has been provided. \n");
 
+		// Mark the wires to declassify.
+		for (auto &declassify_selection : opt_declassify_selections) {
+			RTLIL::Selection sel = eval_select_args({declassify_selection}, design);
+			for (auto module : design->modules())
+				for (auto wire : module->wires())
+					if (sel.selected_member(module->name, wire->name))
+						wire->set_bool_attribute(ID(cellift_declassify));
+		}
+
+		FILE *name_map_file = nullptr;
+		if (!opt_name_map_filename.empty()) {
+			if (!opt_compact_names)
+				log_cmd_error("Option -name-map requires -compact-names.\n");
+			name_map_file = fopen(opt_name_map_filename.c_str(), "w");
+			if (name_map_file == nullptr)
+				log_cmd_error("Can't open file `%s' for writing: %s\n", opt_name_map_filename.c_str(), strerror(errno));
+		}
+		compact_taint_names = opt_compact_names;
+
 		// Run the worker on each module.
 		for (auto i = 0; i < GetSize(topo_modules.sorted); ++i) {
 			RTLIL::Module *module = topo_modules.sorted[i];
 			CellIFTWorker(module, opt_verbose, opt_rtlift, opt_conjunctive_gates, opt_conjunctive_cells_pool, opt_precise_shiftx,
 				      opt_imprecise_shl_sshl, opt_imprecise_shr_sshr, opt_pmux_use_large_cells,
-				      num_taints, &opt_excluded_signals);
+				      num_taints, &opt_excluded_signals, name_map_file);
 		}
+
+		compact_taint_names = false;
+		reset_compact_taint_wires();
+		if (name_map_file != nullptr)
+			fclose(name_map_file);
 	}
 } CelliftPass;
 
@@ -23,6 +23,41 @@ std::string get_wire_taint_idstring(RTLIL::IdString id_string, unsigned int tain
     return id_string.str() + "_t" + std::to_string(taint_id);
 }
 
+// If set, the internal taint wires get compact private names instead of names derived from the original wire.
+bool compact_taint_names = false;
+// For the module being instrumented, maps (original wire, taint id) to the taint wire with a compact name.
+dict<std::pair<RTLIL::Wire*, unsigned int>, RTLIL::Wire*> compact_taint_wires;
+static int compact_taint_wire_counter = 0;
+
+// Must be called before instrumenting each module when using compact taint names.
+void reset_compact_taint_wires() {
+    compact_taint_wires.clear();
+    compact_taint_wire_counter = 0;
+}
+
+// Returns the existing taint wire of the given wire, or nullptr. Ports always keep the readable taint names.
+RTLIL::Wire *get_wire_taint(RTLIL::Module* module, RTLIL::Wire *wire, unsigned int taint_id) {
+    if (compact_taint_names && !wire->port_input && !wire->port_output) {
+        auto it = compact_taint_wires.find(std::make_pair(wire, taint_id));
+        return it == compact_taint_wires.end() ? nullptr : it->second;
+    }
+    return module->wire(get_wire_taint_idstring(wire->name, taint_id));
+}
+
+// Creates the taint wire of the given wire.
+static RTLIL::Wire *add_wire_taint(RTLIL::Module* module, RTLIL::Wire *wire, unsigned int taint_id) {
+    if (compact_taint_names && !wire->port_input && !wire->port_output) {
+        std::string name;
+        do
+            name = "$t" + std::to_string(compact_taint_wire_counter++);
+        while (module->wire(name) != nullptr);
+        RTLIL::Wire *w = module->addWire(name, wire);
+        compact_taint_wires[std::make_pair(wire, taint_id)] = w;
+        return w;
+    }
+    return module->addWire(get_wire_taint_idstring(wire->name, taint_id), wire);
+}
+
 // For a given SigSpec, returns the corresponding taint SigSpec.
 std::vector<RTLIL::SigSpec> get_corresponding_taint_signals(RTLIL::Module* module, std::vector<string> *excluded_signals, const RTLIL::SigSpec &sig, unsigned int num_taints) {
     std::vector<RTLIL::SigSpec> ret(num_taints);
@@ -32,9 +67,9 @@ std::vector<RTLIL::SigSpec> get_corresponding_taint_signals(RTLIL::Module* modul
         for (auto &chunk_it: sig.chunks()) {
 
             if (chunk_it.is_wire() && !is_signal_excluded(excluded_signals, chunk_it.wire->name.str())) {
-                RTLIL::Wire *w = module->wire(get_wire_taint_idstring(chunk_it.wire->name.str(), taint_id));
+                RTLIL::Wire *w = get_wire_taint(module, chunk_it.wire, taint_id);
                 if (w == nullptr) {
-                    w = module->addWire(get_wire_taint_idstring(chunk_it.wire->name.str(), taint_id), chunk_it.wire);
+                    w = add_wire_taint(module, chunk_it.wire, taint_id);
                     w->set_bool_attribute(cellift_attribute_name);
                     w->port_input = false;
                     w->port_output = false;
@@ -0,0 +1,285 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2020  Alberto Gonzalez <boqwxp@airmail.cc> & Flavien Solt <flsolt@ethz.ch>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/register.h"
+#include "kernel/rtlil.h"
+#include "kernel/sigtools.h"
+#include "kernel/utils.h"
+#include "kernel/log.h"
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct PruneTaintPortsWorker {
+private:
+	// Command line arguments.
+	bool opt_verbose;
+	bool opt_noopt;
+
+	RTLIL::Design *design;
+	std::vector<RTLIL::Module*> bottom_up_modules;
+
+	// For each module, the cells instantiating it. Modules without instances are toplevels and keep their interface.
+	dict<RTLIL::IdString, std::vector<RTLIL::Cell*>> instances;
+	// Modules instantiated from outside the selection cannot have their ports pruned.
+	pool<RTLIL::IdString> instantiated_from_unselected;
+
+	const RTLIL::IdString cellift_attribute_name = ID(cellift);
+
+	int num_pruned_outputs = 0;
+	int num_pruned_inputs = 0;
+
+	bool is_prunable_taint_port(RTLIL::Wire *wire) {
+		return wire->get_bool_attribute(cellift_attribute_name) && (wire->port_input != wire->port_output) && !wire->get_bool_attribute(ID::keep);
+	}
+
+	void index_instances() {
+		instances.clear();
+		instantiated_from_unselected.clear();
+		for (auto module : design->modules())
+			for (auto cell : module->cells()) {
+				if (design->module(cell->type) == nullptr)
+					continue;
+				if (design->selected_module(module))
+					instances[cell->type].push_back(cell);
+				else
+					instantiated_from_unselected.insert(cell->type);
+			}
+	}
+
+	// Removes the output taint ports of the module that are provably constant zero and ties the corresponding nets to zero in the parents.
+	bool prune_output_ports(RTLIL::Module *module) {
+		if (!instances.count(module->name) || instantiated_from_unselected.count(module->name))
+			return false;
+
+		SigMap sigmap(module);
+		std::vector<RTLIL::Wire*> pruned_ports;
+		for (auto wire : module->wires()) {
+			if (!wire->port_output || !is_prunable_taint_port(wire))
+				continue;
+			RTLIL::SigSpec sig = sigmap(wire);
+			if (!sig.is_fully_const() || !sig.as_const().is_fully_zero())
+				continue;
+			pruned_ports.push_back(wire);
+		}
+		if (pruned_ports.empty())
+			return false;
+
+		for (auto wire : pruned_ports) {
+			if (opt_verbose)
+				log("Pruning constant-zero output taint port %s of module %s.\n", wire->name.c_str(), module->name.c_str());
+			wire->port_output = false;
+
+			for (auto cell : instances.at(module->name)) {
+				if (!cell->hasPort(wire->name))
+					continue;
+				RTLIL::SigSpec parent_sig = cell->getPort(wire->name);
+				cell->unsetPort(wire->name);
+				for (auto bit : parent_sig)
+					if (bit.wire != nullptr)
+						cell->module->connect(bit, RTLIL::State::S0);
+			}
+		}
+		module->fixup_ports();
+		num_pruned_outputs += GetSize(pruned_ports);
+		return true;
+	}
+
+	// Removes the input taint ports of the module that every instance drives with constant zero, and ties them to zero internally.
+	bool prune_input_ports(RTLIL::Module *module) {
+		if (!instances.count(module->name) || instantiated_from_unselected.count(module->name))
+			return false;
+
+		dict<RTLIL::Module*, SigMap> parent_sigmaps;
+		for (auto cell : instances.at(module->name))
+			if (!parent_sigmaps.count(cell->module))
+				parent_sigmaps[cell->module].set(cell->module);
+
+		std::vector<RTLIL::Wire*> pruned_ports;
+		for (auto wire : module->wires()) {
+			if (!wire->port_input || !is_prunable_taint_port(wire))
+				continue;
+			bool always_zero = true;
+			for (auto cell : instances.at(module->name)) {
+				// An unconnected input port is undriven rather than zero.
+				if (!cell->hasPort(wire->name)) {
+					always_zero = false;
+					break;
+				}
+				RTLIL::SigSpec sig = parent_sigmaps.at(cell->module)(cell->getPort(wire->name));
+				if (!sig.is_fully_const() || !sig.as_const().is_fully_zero()) {
+					always_zero = false;
+					break;
+				}
+			}
+			if (always_zero)
+				pruned_ports.push_back(wire);
+		}
+		if (pruned_ports.empty())
+			return false;
+
+		for (auto wire : pruned_ports) {
+			if (opt_verbose)
+				log("Pruning constant-zero input taint port %s of module %s.\n", wire->name.c_str(), module->name.c_str());
+			wire->port_input = false;
+			module->connect(wire, RTLIL::SigSpec(RTLIL::State::S0, wire->width));
+			for (auto cell : instances.at(module->name))
+				cell->unsetPort(wire->name);
+		}
+		module->fixup_ports();
+		num_pruned_inputs += GetSize(pruned_ports);
+		return true;
+	}
+
+	// Folds the constants of the modules modified since they were last folded.
+	void fold_constants(pool<RTLIL::Module*> &unfolded_modules) {
+		if (!opt_noopt)
+			for (auto module : bottom_up_modules)
+				if (unfolded_modules.count(module))
+					Pass::call_on_module(design, module, "opt_expr; opt_clean");
+		unfolded_modules.clear();
+	}
+
+public:
+	PruneTaintPortsWorker(RTLIL::Design *_design, std::vector<RTLIL::Module*> _bottom_up_modules, bool _opt_verbose, bool _opt_noopt) {
+		design = _design;
+		bottom_up_modules = _bottom_up_modules;
+		opt_verbose = _opt_verbose;
+		opt_noopt = _opt_noopt;
+	}
+
+	void run() {
+		pool<RTLIL::Module*> unfolded_modules(bottom_up_modules.begin(), bottom_up_modules.end());
+
+		// Pruning an output port may make the parents' outputs constant, and pruning an input port may make the child's outputs
+		// constant. Iterate both directions until no more port can be removed.
+		bool did_something = true;
+		while (did_something) {
+			did_something = false;
+
+			// The instance index must be rebuilt after folding, as opt_clean may remove unused instances.
+			fold_constants(unfolded_modules);
+			index_instances();
+			for (auto module : bottom_up_modules)
+				if (prune_output_ports(module)) {
+					for (auto cell : instances.at(module->name))
+						unfolded_modules.insert(cell->module);
+					did_something = true;
+				}
+
+			fold_constants(unfolded_modules);
+			index_instances();
+			for (auto it = bottom_up_modules.rbegin(); it != bottom_up_modules.rend(); ++it)
+				if (prune_input_ports(*it)) {
+					unfolded_modules.insert(*it);
+					did_something = true;
+				}
+		}
+
+		log("Pruned %d output and %d input taint ports.\n", num_pruned_outputs, num_pruned_inputs);
+	}
+};
+
+struct PruneTaintPortsPass : public Pass {
+	PruneTaintPortsPass() : Pass("prune_taint_ports", "remove inter-module taint ports that are always zero.") {}
+
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    prune_taint_ports [options] [selection]\n");
+		log("\n");
+		log("Removes the taint ports added by `cellift` to hierarchical designs whenever they are\n");
+		log("provably constant zero, for example because all the signals they depend on are\n");
+		log("excluded or constant.\n");
+		log("The module graph is traversed bottom-up: an output taint port whose driver folds to\n");
+		log("zero is removed and the nets connected to it in the parents are tied to zero. Then,\n");
+		log("top-down, an input taint port that all instances drive with zero is removed and tied\n");
+		log("to zero inside the module. Both steps are repeated until no more port can be removed.\n");
+		log("The ports of the toplevel modules, and of modules that are also instantiated from\n");
+		log("unselected modules, are never removed.\n");
+		log("\n");
+		log("Options:\n");
+		log("\n");
+		log("  -verbose\n");
+		log("    Verbose mode.\n");
+		log("\n");
+		log("  -noopt\n");
+		log("    Do not run `opt_expr; opt_clean` on the modified modules to fold the constants\n");
+		log("    before inspecting the ports. Only ports directly connected to zero are removed.\n");
+		log("\n");
+	}
+
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		bool opt_verbose = false;
+		bool opt_noopt = false;
+
+		log_header(design, "Executing prune_taint_ports pass.\n");
+
+		std::vector<std::string>::size_type argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-verbose") {
+				opt_verbose = true;
+				continue;
+			}
+			if (args[argidx] == "-noopt") {
+				opt_noopt = true;
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		// Check whether some module is selected.
+		if (GetSize(design->selected_modules()) == 0)
+			log_cmd_error("prune_taint_ports cannot operate on an empty selection.\n");
+
+		// Modules must be taken in inverted topological order to analyze the deepest modules first.
+		// Taken from passes/techmap/flatten.cc
+		TopoSort<RTLIL::Module*, IdString::compare_ptr_by_name<RTLIL::Module>> topo_modules;
+		auto worklist = design->selected_modules();
+		while (!worklist.empty()) {
+			RTLIL::Module *module = *(worklist.begin());
+			worklist.erase(worklist.begin());
+			topo_modules.node(module);
+
+			for (auto cell : module->selected_cells()) {
+				RTLIL::Module *tpl = design->module(cell->type);
+				if (tpl != nullptr && design->selected_module(tpl)) {
+					if (topo_modules.get_database().count(tpl) == 0)
+						worklist.push_back(tpl);
+					topo_modules.edge(tpl, module);
+				}
+			}
+		}
+		if (!topo_modules.sort())
+			log_cmd_error("Recursive modules are not supported by prune_taint_ports.\n");
+
+		for (auto module : topo_modules.sorted)
+			if (module->processes.size())
+				log_cmd_error("Unexpected process in module %s. Requires a `proc` pass before.\n", log_id(module));
+
+		PruneTaintPortsWorker worker(design, topo_modules.sorted, opt_verbose, opt_noopt);
+		worker.run();
+	}
+} PruneTaintPortsPass;
+
+PRIVATE_NAMESPACE_END
@@ -138,6 +138,7 @@ struct ConnwrappersWorker
 							log_id(conn.first), log_signal(old_sig), log_signal(conn.second));
 			}
 		}
+		module->touch();
 	}
 };
 
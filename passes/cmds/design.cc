@@ -26,6 +26,18 @@ YOSYS_NAMESPACE_BEGIN
 std::map<std::string, RTLIL::Design*> saved_designs;
 std::vector<RTLIL::Design*> pushed_designs;
 
+// Hands the modules over to another design without copying them, for the modes
+// that clear the source design anyway.
+static void move_modules(RTLIL::Design *from, RTLIL::Design *to)
+{
+	for (auto mod : from->modules().to_vector()) {
+		for (auto mon : from->monitors)
+			mon->notify_module_del(mod);
+		from->modules_.erase(mod->name);
+		to->add(mod);
+	}
+}
+
 struct DesignPass : public Pass {
 	DesignPass() : Pass("design", "save, restore and reset current design") { }
 	~DesignPass() override {
@@ -47,12 +59,15 @@ struct DesignPass : public Pass {
 		log("\n");
 		log("    design -save <name>\n");
 		log("\n");
-		log("Save the current design under the given name.\n");
+		log("Save the current design under the given name. This makes a full copy of every\n");
+		log("module, as do -push-copy, -load, -copy-from and -copy-to. Only -stash, -push\n");
+		log("and -pop avoid the copy, by moving the modules.\n");
 		log("\n");
 		log("\n");
 		log("    design -stash <name>\n");
 		log("\n");
 		log("Save the current design under the given name and then clear the current design.\n");
+		log("Unlike -save, this moves the modules instead of copying them.\n");
 		log("\n");
 		log("\n");
 		log("    design -push\n");
@@ -341,18 +356,27 @@ struct DesignPass : public Pass {
 
 		if (!save_name.empty() || push_mode || push_copy_mode)
 		{
+			// The old copy is not needed for the new one
+			if (saved_designs.count(save_name)) {
+				delete saved_designs.at(save_name);
+				saved_designs.erase(save_name);
+			}
+
 			RTLIL::Design *design_copy = new RTLIL::Design;
 
-			for (auto mod : design->modules())
-				design_copy->add(mod->clone());
+			// Modules cannot be shared with the copy: passes write cells, attributes
+			// and parameters directly, so there is no hook to clone them on the first
+			// change.
+			if (reset_mode || push_mode)
+				move_modules(design, design_copy);
+			else
+				for (auto mod : design->modules())
+					design_copy->add(mod->clone());
 
 			design_copy->selection_stack = design->selection_stack;
 			design_copy->selection_vars = design->selection_vars;
 			design_copy->selected_active_module = design->selected_active_module;
 
-			if (saved_designs.count(save_name))
-				delete saved_designs.at(save_name);
-
 			if (push_mode || push_copy_mode)
 				pushed_designs.push_back(design_copy);
 			else
@@ -388,8 +412,11 @@ struct DesignPass : public Pass {
 		{
 			RTLIL::Design *saved_design = pop_mode ? pushed_designs.back() : saved_designs.at(load_name);
 
-			for (auto mod : saved_design->modules())
-				design->add(mod->clone());
+			if (pop_mode)
+				move_modules(saved_design, design);
+			else
+				for (auto mod : saved_design->modules())
+					design->add(mod->clone());
 
 			design->selection_stack = saved_design->selection_stack;
 			design->selection_vars = saved_design->selection_vars;
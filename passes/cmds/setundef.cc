@@ -511,6 +511,7 @@ struct SetundefPass : public Pass {
 				worker(it.first);
 				worker(it.second);
 			}
+			module->touch();
 
 			if (worker.next_bit_mode == MODE_ANYSEQ || worker.next_bit_mode == MODE_ANYCONST)
 			{
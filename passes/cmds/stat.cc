@@ -352,7 +352,8 @@ void read_liberty_cellarea(dict<IdString, cell_area_t> &cell_area, string libert
 	yosys_input_files.insert(liberty_file);
 	if (f.fail())
 		log_cmd_error("Can't open liberty file `%s': %s\n", liberty_file.c_str(), strerror(errno));
-	LibertyParser libparser(f);
+	// only the area and the kind of the cells is used
+	LibertyParser libparser(f, liberty_file, {"pin", "bus", "bundle"});
 	f.close();
 
 	for (auto cell : libparser.ast->children)
@@ -384,7 +385,9 @@ struct StatPass : public Pass {
 		log("        default value for this option.\n");
 		log("\n");
 		log("    -liberty <liberty_file>\n");
-		log("        use cell area information from the provided liberty file\n");
+		log("        use cell area information from the provided liberty file. the parsed\n");
+		log("        file is cached in the directory given by the scratchpad variable\n");
+		log("        liberty.cache, if set.\n");
 		log("\n");
 		log("    -tech <technology>\n");
 		log("        print area estimate for the specified technology. Currently supported\n");
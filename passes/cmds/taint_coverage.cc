@@ -0,0 +1,307 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2020  Alberto Gonzalez <boqwxp@airmail.cc> & Flavien Solt <flsolt@ethz.ch>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/register.h"
+#include "kernel/rtlil.h"
+#include "kernel/utils.h"
+#include "kernel/log.h"
+#include "kernel/yosys.h"
+#include "kernel/ff.h"
+#include "kernel/json.h"
+
+USING_YOSYS_NAMESPACE
+PRIVATE_NAMESPACE_BEGIN
+
+struct TaintCoverageWorker {
+private:
+	// Command line arguments.
+	bool opt_verbose;
+	bool opt_per_bit;
+	bool opt_clear;
+
+	const RTLIL::IdString taint_coverage_attribute_name = ID(taint_coverage);
+	const RTLIL::IdString coverage_port_name = ID(taint_cov);
+	const RTLIL::IdString clear_port_name = ID(taint_cov_clear);
+	// Stores the space-separated names of the coverage bits on the coverage port, for later runs.
+	const RTLIL::IdString coverage_bits_attribute_name = ID(taint_coverage_bits);
+
+	// For each instrumented module, the description of each bit of its coverage port, relative to the module.
+	dict<RTLIL::IdString, std::vector<std::string>> coverage_bits;
+
+	static std::string join_tokens(const std::vector<std::string> &tokens) {
+		std::string joined;
+		for (auto &token : tokens) {
+			if (!joined.empty())
+				joined += " ";
+			joined += token;
+		}
+		return joined;
+	}
+
+	// Adds a flip-flop that is set as soon as any bit of the given taint is set, and only
+	// cleared by the clear input, if there is one.
+	RTLIL::SigBit add_sticky_bit(RTLIL::Module *module, RTLIL::Cell *cell, const FfData &ff, RTLIL::SigSpec taint, RTLIL::Wire *clear) {
+		RTLIL::Wire *sticky = module->addWire(NEW_ID);
+		sticky->attributes[ID::init] = RTLIL::Const(RTLIL::State::S0, 1);
+
+		RTLIL::SigBit any_taint = GetSize(taint) == 1 ? taint : module->ReduceOr(NEW_ID, taint, false, cell->get_src_attribute());
+		RTLIL::SigSpec next_sticky = module->Or(NEW_ID, sticky, any_taint, false, cell->get_src_attribute());
+		if (clear != nullptr)
+			next_sticky = module->Mux(NEW_ID, next_sticky, RTLIL::State::S0, clear, cell->get_src_attribute());
+		RTLIL::Cell *sticky_ff = module->addDff(NEW_ID, ff.sig_clk, next_sticky, sticky, ff.pol_clk, cell->get_src_attribute());
+		sticky_ff->set_bool_attribute(ID(taint_coverage_ff));
+		return sticky;
+	}
+
+	void create_taint_coverage(RTLIL::Module *module) {
+		if (opt_verbose)
+			log("Creating taint coverage bits for module %s.\n", module->name.c_str());
+
+		if (module->processes.size())
+			log_error("Unexpected process. Requires a `proc` pass before.\n");
+
+		std::vector<std::string> &bit_names = coverage_bits[module->name];
+
+		if (module->get_bool_attribute(taint_coverage_attribute_name)) {
+			log("Taint coverage has already been applied to module %s. Skipping.\n", module->name.c_str());
+			// Recover the bit names from the previous run, so that the parents and the index still see them.
+			RTLIL::Wire *coverage_port = module->wire(coverage_port_name);
+			if (coverage_port != nullptr)
+				bit_names = split_tokens(coverage_port->get_string_attribute(coverage_bits_attribute_name));
+			if (coverage_port != nullptr && GetSize(bit_names) != GetSize(coverage_port))
+				log_error("The '%s' port of module %s does not match its '%s' attribute.\n", log_id(coverage_port_name),
+						log_id(module), log_id(coverage_bits_attribute_name));
+			return;
+		}
+
+		RTLIL::SigSpec coverage_sig;
+
+		// The clear input, created with the first coverage bit
+		RTLIL::Wire *clear = nullptr;
+		auto get_clear = [&]() {
+			if (opt_clear && clear == nullptr) {
+				clear = module->addWire(clear_port_name);
+				clear->port_input = true;
+			}
+			return clear;
+		};
+
+		for (auto cell : module->cells().to_vector()) {
+			if (cell->has_attribute(ID(taint_ff)) && RTLIL::builtin_ff_cell_types().count(cell->type)) {
+				FfData ff(nullptr, cell);
+				if (!ff.has_clk) {
+					if (opt_verbose)
+						log("Skipping unclocked state element %s of type %s in module %s.\n", cell->name.c_str(), cell->type.c_str(), module->name.c_str());
+					continue;
+				}
+
+				if (opt_per_bit) {
+					for (int bit_id = 0; bit_id < GetSize(ff.sig_q); bit_id++) {
+						coverage_sig.append(add_sticky_bit(module, cell, ff, ff.sig_q[bit_id], get_clear()));
+						bit_names.push_back(RTLIL::unescape_id(cell->name) + "[" + std::to_string(bit_id) + "]");
+					}
+				} else {
+					coverage_sig.append(add_sticky_bit(module, cell, ff, ff.sig_q, get_clear()));
+					bit_names.push_back(RTLIL::unescape_id(cell->name));
+				}
+			}
+
+			else if (coverage_bits.count(cell->type) && !coverage_bits.at(cell->type).empty()) {
+				const std::vector<std::string> &submodule_bit_names = coverage_bits.at(cell->type);
+				RTLIL::Wire *submodule_coverage = module->addWire(NEW_ID, GetSize(submodule_bit_names));
+				cell->setPort(coverage_port_name, submodule_coverage);
+				coverage_sig.append(submodule_coverage);
+				if (opt_clear) {
+					RTLIL::Module *submodule = module->design->module(cell->type);
+					RTLIL::Wire *submodule_clear = submodule->wire(clear_port_name);
+					if (submodule_clear != nullptr && submodule_clear->port_input)
+						cell->setPort(clear_port_name, get_clear());
+					else
+						log_warning("Module %s has no '%s' input, the coverage bits of %s.%s cannot be cleared.\n",
+								log_id(submodule), log_id(clear_port_name), log_id(module), log_id(cell));
+				}
+				for (auto &submodule_bit_name : submodule_bit_names)
+					bit_names.push_back(RTLIL::unescape_id(cell->name) + "." + submodule_bit_name);
+			}
+		}
+
+		if (GetSize(coverage_sig)) {
+			RTLIL::Wire *coverage_port = module->addWire(coverage_port_name, GetSize(coverage_sig));
+			coverage_port->port_output = true;
+			coverage_port->set_string_attribute(coverage_bits_attribute_name, join_tokens(bit_names));
+			module->connect(coverage_port, coverage_sig);
+			module->fixup_ports();
+		}
+
+		if (opt_verbose)
+			log("Module %s has %d taint coverage bits.\n", module->name.c_str(), GetSize(bit_names));
+		module->set_bool_attribute(taint_coverage_attribute_name, true);
+	}
+
+public:
+	TaintCoverageWorker(bool _opt_verbose, bool _opt_per_bit, bool _opt_clear) {
+		opt_verbose = _opt_verbose;
+		opt_per_bit = _opt_per_bit;
+		opt_clear = _opt_clear;
+	}
+
+	void run(const std::vector<RTLIL::Module*> &bottom_up_modules) {
+		for (auto module : bottom_up_modules)
+			create_taint_coverage(module);
+	}
+
+	void write_index(const std::string &filename, const std::vector<RTLIL::Module*> &top_modules) {
+		PrettyJson json;
+		if (!json.write_to_file(filename))
+			log_error("Can't open file `%s' for writing: %s\n", filename.c_str(), strerror(errno));
+
+		json.begin_object();
+		json.entry("generator", yosys_version_str);
+		json.name("modules");
+		json.begin_object();
+		for (auto module : top_modules) {
+			const std::vector<std::string> &bit_names = coverage_bits.at(module->name);
+			json.name(RTLIL::unescape_id(module->name).c_str());
+			json.begin_object();
+			json.entry("port", RTLIL::unescape_id(coverage_port_name));
+			json.entry("width", GetSize(bit_names));
+			json.name("bits");
+			json.begin_array();
+			for (auto &bit_name : bit_names)
+				json.value(bit_name);
+			json.end_array();
+			json.end_object();
+		}
+		json.end_object();
+		json.end_object();
+	}
+};
+
+struct TaintCoveragePass : public Pass {
+	TaintCoveragePass() : Pass("taint_coverage", "add sticky coverage bits recording which taint flip-flops were ever tainted.") {}
+
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    taint_coverage [options] [selection]\n");
+		log("\n");
+		log("Adds a sticky flip-flop to each clocked taint flip-flop (i.e., with the attribute\n");
+		log("'taint_ff', as created by `cellift`). The sticky flip-flop is set as soon as any\n");
+		log("bit of the taint flip-flop is set, and is only cleared through -clear. All the\n");
+		log("sticky bits of a module and of its submodules are packed into the output port\n");
+		log("'taint_cov', so that the coverage of a whole test can be read once at its end,\n");
+		log("instead of sampling the taint probes at every cycle.\n");
+		log("\n");
+		log("Options:\n");
+		log("\n");
+		log("  -verbose\n");
+		log("    Verbose mode.\n");
+		log("\n");
+		log("  -per-bit\n");
+		log("    Add one sticky bit per taint flip-flop bit instead of one per register word.\n");
+		log("\n");
+		log("  -clear\n");
+		log("    Add the input port 'taint_cov_clear' next to each 'taint_cov' port. While it is\n");
+		log("    high, the sticky bits are cleared on the clock edges of their taint flip-flops,\n");
+		log("    e.g. to measure the coverage of several tests in one simulation.\n");
+		log("\n");
+		log("  -index <file>\n");
+		log("    Write a JSON index to <file>, which gives the hierarchical name of the taint\n");
+		log("    flip-flop corresponding to each bit of the 'taint_cov' port of the toplevel\n");
+		log("    modules.\n");
+		log("\n");
+		log("Submodules that are not selected are not instrumented. Modules instrumented by a\n");
+		log("previous run are kept as they are, and their bits are recovered from the\n");
+		log("'taint_coverage_bits' attribute of their 'taint_cov' port.\n");
+		log("\n");
+	}
+
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		bool opt_verbose = false;
+		bool opt_per_bit = false;
+		bool opt_clear = false;
+		std::string opt_index_filename;
+
+		log_header(design, "Executing taint_coverage pass.\n");
+
+		std::vector<std::string>::size_type argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-verbose") {
+				opt_verbose = true;
+				continue;
+			}
+			if (args[argidx] == "-per-bit") {
+				opt_per_bit = true;
+				continue;
+			}
+			if (args[argidx] == "-clear") {
+				opt_clear = true;
+				continue;
+			}
+			if (args[argidx] == "-index" && argidx + 1 < args.size()) {
+				opt_index_filename = args[++argidx];
+				continue;
+			}
+			break;
+		}
+		extra_args(args, argidx, design);
+
+		// Check whether some module is selected.
+		if (GetSize(design->selected_modules()) == 0)
+			log_cmd_error("taint_coverage cannot operate on an empty selection.\n");
+
+		// Modules must be taken in inverted topological order to instrument the deepest modules first.
+		// Taken from passes/techmap/flatten.cc
+		TopoSort<RTLIL::Module*, IdString::compare_ptr_by_name<RTLIL::Module>> topo_modules;
+		pool<RTLIL::IdString> non_top_modules;
+		auto worklist = design->selected_modules();
+		while (!worklist.empty()) {
+			RTLIL::Module *module = *(worklist.begin());
+			worklist.erase(worklist.begin());
+			topo_modules.node(module);
+
+			for (auto cell : module->selected_cells()) {
+				RTLIL::Module *tpl = design->module(cell->type);
+				if (tpl != nullptr && design->selected_module(tpl)) {
+					if (topo_modules.get_database().count(tpl) == 0)
+						worklist.push_back(tpl);
+					topo_modules.edge(tpl, module);
+					non_top_modules.insert(cell->type);
+				}
+			}
+		}
+		if (!topo_modules.sort())
+			log_cmd_error("Recursive modules are not supported by taint_coverage.\n");
+
+		TaintCoverageWorker worker(opt_verbose, opt_per_bit, opt_clear);
+		worker.run(topo_modules.sorted);
+
+		if (!opt_index_filename.empty()) {
+			std::vector<RTLIL::Module*> top_modules;
+			for (auto module : topo_modules.sorted)
+				if (!non_top_modules.count(module->name))
+					top_modules.push_back(module);
+			worker.write_index(opt_index_filename, top_modules);
+		}
+	}
+} TaintCoveragePass;
+
+PRIVATE_NAMESPACE_END
@@ -0,0 +1,314 @@
+/*
+ *  yosys -- Yosys Open SYnthesis Suite
+ *
+ *  Copyright (C) 2020  Alberto Gonzalez <boqwxp@airmail.cc> & Flavien Solt <flsolt@ethz.ch>
+ *
+ *  Permission to use, copy, modify, and/or distribute this software for any
+ *  purpose with or without fee is hereby granted, provided that the above
+ *  copyright notice and this permission notice appear in all copies.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ *  WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ *  MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ *  ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ *  WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ *  ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ *  OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ */
+
+#include "kernel/register.h"
+#include "kernel/rtlil.h"
+#include "kernel/utils.h"
+#include "kernel/log.h"
+#include "kernel/yosys.h"
+
+USING_YOSYS_NAMESPACE
+
+extern std::string get_wire_taint_idstring(RTLIL::IdString id_string, unsigned int taint_id);
+extern RTLIL::Wire *get_wire_taint(RTLIL::Module *module, RTLIL::Wire *wire, unsigned int taint_id);
+
+PRIVATE_NAMESPACE_BEGIN
+
+struct TaintLeakMonitorWorker {
+private:
+	// Command line arguments.
+	bool opt_verbose;
+	bool opt_assert;
+	unsigned int num_taints;
+	std::string opt_clk;
+	int opt_cycle_width;
+
+	RTLIL::Design *design;
+
+	const RTLIL::IdString cellift_attribute_name = ID(cellift);
+	const RTLIL::IdString leak_port_name = ID(taint_leak);
+	const RTLIL::IdString leak_cycle_port_name = ID(taint_leak_cycle);
+
+	// The modules that expose a leak port, either because they contain sinks or because one of their submodules does.
+	pool<RTLIL::IdString> leaking_modules;
+
+	// For each module, maps the readable names of the compact taint wires, as written by `cellift -name-map`, to the compact names.
+	dict<std::string, dict<RTLIL::IdString, RTLIL::IdString>> compact_names;
+
+	// Returns the taint wire of the given original wire, or nullptr if it has none.
+	RTLIL::Wire *find_wire_taint(RTLIL::Module *module, RTLIL::Wire *wire, unsigned int taint_id) {
+		RTLIL::Wire *taint_wire = get_wire_taint(module, wire, taint_id);
+		if (taint_wire != nullptr)
+			return taint_wire;
+
+		auto module_it = compact_names.find(log_id(module));
+		if (module_it == compact_names.end())
+			return nullptr;
+		auto name_it = module_it->second.find(get_wire_taint_idstring(wire->name, taint_id));
+		return name_it == module_it->second.end() ? nullptr : module->wire(name_it->second);
+	}
+
+	// Appends the taint bits of the given sink wire to sig. If the wire is itself a taint wire, it is appended as is. Returns false if
+	// the wire has no taint.
+	bool get_sink_taint(RTLIL::Module *module, RTLIL::Wire *wire, RTLIL::SigSpec &sig) {
+		if (wire->get_bool_attribute(cellift_attribute_name)) {
+			sig.append(wire);
+			return true;
+		}
+
+		RTLIL::SigSpec ret;
+		for (unsigned int taint_id = 0; taint_id < num_taints; taint_id++) {
+			RTLIL::Wire *taint_wire = find_wire_taint(module, wire, taint_id);
+			if (taint_wire == nullptr)
+				return false;
+			ret.append(taint_wire);
+		}
+		sig.append(ret);
+		return true;
+	}
+
+	void create_leak_monitor(RTLIL::Module *module, bool is_top) {
+		RTLIL::SigSpec leak_sig;
+
+		// When a whole module is selected, its untainted wires (e.g., excluded signals or constants) are simply not sinks.
+		bool whole_module = design->selected_whole_module(module);
+		for (auto wire : module->selected_wires()) {
+			if (wire->has_attribute(ID(taint_leak_monitor)))
+				continue;
+			if (!get_sink_taint(module, wire, leak_sig)) {
+				if (!whole_module)
+					log_cmd_error("Sink signal %s of module %s has no taint signal. Has `cellift` been run? With `cellift -compact-names`, "
+							"internal signals are only found through the -name-map option.\n", wire->name.c_str(), module->name.c_str());
+				if (opt_verbose)
+					log("Skipping untainted signal %s of module %s.\n", wire->name.c_str(), module->name.c_str());
+				continue;
+			}
+			if (opt_verbose)
+				log("Adding sink %s of module %s.\n", wire->name.c_str(), module->name.c_str());
+		}
+		// Selecting a whole module selects both the original signals and their taints.
+		leak_sig.sort_and_unify();
+
+		for (auto cell : module->cells()) {
+			if (!leaking_modules.count(cell->type))
+				continue;
+			RTLIL::Wire *submodule_leak = module->addWire(NEW_ID);
+			cell->setPort(leak_port_name, submodule_leak);
+			leak_sig.append(submodule_leak);
+		}
+
+		if (leak_sig.empty())
+			return;
+		leaking_modules.insert(module->name);
+
+		if (opt_verbose)
+			log("Module %s monitors %d taint bits.\n", module->name.c_str(), GetSize(leak_sig));
+
+		RTLIL::Wire *leak_port = module->addWire(leak_port_name);
+		leak_port->port_output = true;
+		leak_port->set_bool_attribute(ID(taint_leak_monitor));
+		module->addReduceOr(NEW_ID, leak_sig, leak_port);
+
+		if (is_top && opt_assert) {
+			RTLIL::Cell *assert_cell = module->addAssert(NEW_ID, module->LogicNot(NEW_ID, leak_port), RTLIL::State::S1);
+			assert_cell->set_bool_attribute(ID(taint_leak_monitor));
+		}
+
+		if (is_top && !opt_clk.empty()) {
+			RTLIL::Wire *clk = module->wire(RTLIL::escape_id(opt_clk));
+			if (clk == nullptr)
+				log_cmd_error("Clock signal %s not found in toplevel module %s.\n", opt_clk.c_str(), module->name.c_str());
+
+			// Free-running cycle counter.
+			RTLIL::Wire *cycle = module->addWire(NEW_ID, opt_cycle_width);
+			cycle->attributes[ID::init] = RTLIL::Const(0, opt_cycle_width);
+			module->addDff(NEW_ID, clk, module->Add(NEW_ID, cycle, RTLIL::Const(1, opt_cycle_width)), cycle);
+
+			// Sticky leak flag, and the cycle at which it was first raised.
+			RTLIL::Wire *leaked = module->addWire(NEW_ID);
+			leaked->attributes[ID::init] = RTLIL::Const(0, 1);
+			module->addDff(NEW_ID, clk, module->Or(NEW_ID, leaked, leak_port), leaked);
+
+			RTLIL::Wire *leak_cycle = module->addWire(leak_cycle_port_name, opt_cycle_width);
+			leak_cycle->port_output = true;
+			leak_cycle->attributes[ID::init] = RTLIL::Const(0, opt_cycle_width);
+			leak_cycle->set_bool_attribute(ID(taint_leak_monitor));
+			RTLIL::SigSpec first_leak = module->And(NEW_ID, leak_port, module->Not(NEW_ID, leaked));
+			module->addDffe(NEW_ID, clk, first_leak, cycle, leak_cycle);
+		}
+
+		module->fixup_ports();
+	}
+
+public:
+	void read_name_map(const std::string &filename) {
+		std::ifstream f(filename);
+		if (f.fail())
+			log_cmd_error("Can't open name map file `%s': %s\n", filename.c_str(), strerror(errno));
+
+		std::string line;
+		while (std::getline(f, line)) {
+			std::vector<std::string> tokens = split_tokens(line);
+			if (tokens.empty())
+				continue;
+			if (GetSize(tokens) != 3)
+				log_cmd_error("Malformed line in name map file `%s': %s\n", filename.c_str(), line.c_str());
+			compact_names[tokens[0]][tokens[2]] = tokens[1];
+		}
+	}
+
+	TaintLeakMonitorWorker(RTLIL::Design *_design, bool _opt_verbose, bool _opt_assert, unsigned int _num_taints, std::string _opt_clk, int _opt_cycle_width) {
+		design = _design;
+		opt_verbose = _opt_verbose;
+		opt_assert = _opt_assert;
+		num_taints = _num_taints;
+		opt_clk = _opt_clk;
+		opt_cycle_width = _opt_cycle_width;
+	}
+
+	void run(const std::vector<RTLIL::Module*> &bottom_up_modules, const pool<RTLIL::IdString> &non_top_modules) {
+		for (auto module : bottom_up_modules) {
+			if (module->processes.size())
+				log_error("Unexpected process in module %s. Requires a `proc` pass before.\n", module->name.c_str());
+			if (module->wire(leak_port_name) != nullptr)
+				log_cmd_error("Module %s already has a %s signal.\n", module->name.c_str(), leak_port_name.c_str());
+			create_leak_monitor(module, !non_top_modules.count(module->name));
+		}
+		if (leaking_modules.empty())
+			log_warning("No sink signal has been selected.\n");
+	}
+};
+
+struct TaintLeakMonitorPass : public Pass {
+	TaintLeakMonitorPass() : Pass("taint_leak_monitor", "flag the first cycle at which taint reaches the selected sinks.") {}
+
+	void help() override
+	{
+		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
+		log("\n");
+		log("    taint_leak_monitor [options] <selection>\n");
+		log("\n");
+		log("Builds an OR tree of the taints of the selected sink signals, which must have been\n");
+		log("instrumented by `cellift`. Each module containing sinks, or instantiating such a\n");
+		log("module, gets a 'taint_leak' output port, which is raised whenever any of its sinks\n");
+		log("is tainted. A simulation harness then only needs to poll a single bit, or to rely\n");
+		log("on the options below to detect the first leak.\n");
+		log("The selected wires may either be original signals, whose taints are looked up by\n");
+		log("name, or taint signals. When a whole module is selected, its signals without a\n");
+		log("taint are ignored.\n");
+		log("\n");
+		log("Options:\n");
+		log("\n");
+		log("  -verbose\n");
+		log("    Verbose mode.\n");
+		log("\n");
+		log("  -num-distinct-labels <n>\n");
+		log("    The number of distinct labels used by `cellift`. Default: 1.\n");
+		log("\n");
+		log("  -assert\n");
+		log("    Add an $assert cell to the toplevel modules, which fails as soon as\n");
+		log("    'taint_leak' is raised. This lets `sim -assert` and simulators supporting\n");
+		log("    immediate assertions stop at the first leak.\n");
+		log("\n");
+		log("  -clk <signal>\n");
+		log("    Add a 'taint_leak_cycle' output port to the toplevel modules, holding the\n");
+		log("    number of cycles of the given clock elapsed before the first leak.\n");
+		log("\n");
+		log("  -cycle-width <n>\n");
+		log("    The width of the cycle counter used with -clk, between 1 and 64. Default: 64.\n");
+		log("\n");
+		log("  -name-map <file>\n");
+		log("    Read the name map written by `cellift -compact-names -name-map`, to find the\n");
+		log("    taints of internal signals that were given compact names.\n");
+		log("\n");
+	}
+
+	void execute(std::vector<std::string> args, RTLIL::Design *design) override
+	{
+		bool opt_verbose = false;
+		bool opt_assert = false;
+		unsigned int num_taints = 1;
+		std::string opt_clk;
+		int opt_cycle_width = 64;
+		std::string opt_name_map;
+
+		log_header(design, "Executing taint_leak_monitor pass.\n");
+
+		std::vector<std::string>::size_type argidx;
+		for (argidx = 1; argidx < args.size(); argidx++) {
+			if (args[argidx] == "-verbose") {
+				opt_verbose = true;
+				continue;
+			}
+			if (args[argidx] == "-num-distinct-labels" && argidx + 1 < args.size()) {
+				num_taints = std::stoi(args[++argidx]);
+				continue;
+			}
+			if (args[argidx] == "-assert") {
+				opt_assert = true;
+				continue;
+			}
+			if (args[argidx] == "-clk" && argidx + 1 < args.size()) {
+				opt_clk = args[++argidx];
+				continue;
+			}
+			if (args[argidx] == "-cycle-width" && argidx + 1 < args.size()) {
+				opt_cycle_width = atoi(args[++argidx].c_str());
+				continue;
+			}
+			if (args[argidx] == "-name-map" && argidx + 1 < args.size()) {
+				opt_name_map = args[++argidx];
+				continue;
+			}
+			break;
+		}
+		if (argidx == args.size())
+			log_cmd_error("No sink signal selection provided.\n");
+		extra_args(args, argidx, design);
+
+		if (opt_cycle_width <= 0 || opt_cycle_width > 64)
+			log_cmd_error("The cycle counter width must be between 1 and 64, got %d.\n", opt_cycle_width);
+
+		// Modules must be taken in inverted topological order to instrument the deepest modules first.
+		// Unlike the sinks, the hierarchy is not restricted to the selection.
+		TopoSort<RTLIL::Module*, IdString::compare_ptr_by_name<RTLIL::Module>> topo_modules;
+		pool<RTLIL::IdString> non_top_modules;
+		for (auto module : design->modules()) {
+			if (module->get_blackbox_attribute())
+				continue;
+			topo_modules.node(module);
+			for (auto cell : module->cells()) {
+				RTLIL::Module *tpl = design->module(cell->type);
+				if (tpl != nullptr && !tpl->get_blackbox_attribute()) {
+					topo_modules.edge(tpl, module);
+					non_top_modules.insert(cell->type);
+				}
+			}
+		}
+		if (!topo_modules.sort())
+			log_cmd_error("Recursive modules are not supported by taint_leak_monitor.\n");
+
+		TaintLeakMonitorWorker worker(design, opt_verbose, opt_assert, num_taints, opt_clk, opt_cycle_width);
+		if (!opt_name_map.empty())
+			worker.read_name_map(opt_name_map);
+		worker.run(topo_modules.sorted, non_top_modules);
+	}
+} TaintLeakMonitorPass;
+
+PRIVATE_NAMESPACE_END
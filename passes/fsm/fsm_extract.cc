@@ -461,6 +461,8 @@ struct FsmExtractPass : public Pass {
 					wire_list.push_back(wire);
 			for (auto wire : wire_list)
 				extract_fsm(wire);
+			if (!wire_list.empty())
+				module->touch();
 		}
 
 		assign_map.clear();
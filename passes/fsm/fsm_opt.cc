@@ -342,8 +342,10 @@ struct FsmOptPass : public Pass {
 
 		for (auto mod : design->selected_modules())
 			for (auto cell : mod->selected_cells())
-				if (cell->type == ID($fsm))
+				if (cell->type == ID($fsm)) {
 					FsmData::optimize_fsm(cell, mod);
+					mod->touch();
+				}
 	}
 } FsmOptPass;
 
@@ -315,6 +315,7 @@ struct IFExpander
 		for(unsigned int i=0;i<connections_to_remove.size();i++) {
 			cell.connections_.erase(connections_to_remove[i]);
 		}
+		cell.module->touch();
 	}
 };
 
@@ -800,6 +801,14 @@ struct HierarchyPass : public Pass {
 		log("       This option can be specified multiple times to override multiple\n");
 		log("       parameters. String values must be passed in double quotes (\").\n");
 		log("\n");
+		log("    -derive-cache <directory>\n");
+		log("        store the RTLIL of the modules derived from parametric modules in the\n");
+		log("        given directory, and load it from there when the same module with the\n");
+		log("        same parameters is derived again, e.g. by a later run. The files are\n");
+		log("        keyed by a hash of the module's source and parameters. This sets the\n");
+		log("        scratchpad variable 'ast.derive_cache' for the duration of the pass;\n");
+		log("        setting the variable directly enables the cache for all derivations.\n");
+		log("\n");
 		log("In -generate mode this pass generates blackbox modules for the given cell\n");
 		log("types (wildcards supported). For this the design is searched for cells that\n");
 		log("match the given types and then the given port declarations are used to\n");
@@ -827,6 +836,7 @@ struct HierarchyPass : public Pass {
 		bool purge_lib = false;
 		RTLIL::Module *top_mod = NULL;
 		std::string load_top_mod;
+		std::string derive_cache;
 		std::vector<std::string> libdirs;
 
 		bool auto_top_mode = false;
@@ -932,6 +942,10 @@ struct HierarchyPass : public Pass {
 				auto_top_mode = true;
 				continue;
 			}
+			if (args[argidx] == "-derive-cache" && argidx+1 < args.size()) {
+				derive_cache = args[++argidx];
+				continue;
+			}
 			if (args[argidx] == "-chparam"  && argidx+2 < args.size()) {
 				const std::string &key = args[++argidx];
 				const std::string &value = args[++argidx];
@@ -946,6 +960,10 @@ struct HierarchyPass : public Pass {
 		}
 		extra_args(args, argidx, design, false);
 
+		std::string bak_derive_cache = design->scratchpad_get_string("ast.derive_cache");
+		if (!derive_cache.empty() && !generate_mode)
+			design->scratchpad_set_string("ast.derive_cache", derive_cache);
+
 		if (!load_top_mod.empty())
 		{
 			IdString top_name = RTLIL::escape_id(load_top_mod);
@@ -1206,6 +1224,7 @@ struct HierarchyPass : public Pass {
 						new_connections[conn.first] = conn.second;
 				}
 				cell->connections_ = new_connections;
+				module->touch();
 			}
 		}
 
@@ -1478,6 +1497,13 @@ struct HierarchyPass : public Pass {
 		for (auto module : blackbox_derivatives)
 			design->remove(module);
 
+		if (!derive_cache.empty()) {
+			if (bak_derive_cache.empty())
+				design->scratchpad_unset("ast.derive_cache");
+			else
+				design->scratchpad_set_string("ast.derive_cache", bak_derive_cache);
+		}
+
 		log_pop();
 	}
 } HierarchyPass;
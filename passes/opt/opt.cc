@@ -25,6 +25,44 @@
 USING_YOSYS_NAMESPACE
 PRIVATE_NAMESPACE_BEGIN
 
+// The part of the current selection that lies in modules changed since the given
+// generation. The other modules have reached their fixpoint and are skipped. The
+// opt_* passes touch every module for which they report opt.did_something, so that
+// changes made by direct writes to cell types, parameters or attributes count too.
+RTLIL::Selection changed_selection(RTLIL::Design *design, uint64_t since)
+{
+	RTLIL::Selection sel(false);
+	for (auto module : design->selected_modules()) {
+		if (module->generation <= since)
+			continue;
+		if (design->selected_whole_module(module->name)) {
+			sel.select(module);
+			continue;
+		}
+		for (auto wire : module->selected_wires())
+			sel.select(module, wire);
+		for (auto cell : module->selected_cells())
+			sel.select(module, cell);
+		for (auto &it : module->memories)
+			if (design->selected(module, it.second))
+				sel.select(module, it.second);
+		for (auto &it : module->processes)
+			if (design->selected(module, it.second))
+				sel.select(module, it.second);
+	}
+	return sel;
+}
+
+// Runs the command on the whole selection in the first round, and then only on the
+// modules changed by the previous round.
+void call_on_round(RTLIL::Design *design, const RTLIL::Selection *round_sel, const std::string &command)
+{
+	if (round_sel == nullptr)
+		Pass::call(design, command);
+	else
+		Pass::call_on_selection(design, *round_sel, command);
+}
+
 struct OptPass : public Pass {
 	OptPass() : Pass("opt", "perform simple optimizations") { }
 	void help() override
@@ -59,6 +97,9 @@ struct OptPass : public Pass {
 		log("        opt_clean [-purge]\n");
 		log("    while <changed design in opt_dff>\n");
 		log("\n");
+		log("After the first iteration, the loop only runs on the modules that have been\n");
+		log("changed by the previous iteration.\n");
+		log("\n");
 		log("Note: Options in square brackets (such as [-keepdc]) are passed through to\n");
 		log("the opt_* commands when given to 'opt'.\n");
 		log("\n");
@@ -145,17 +186,21 @@ struct OptPass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
+		std::unique_ptr<RTLIL::Selection> round_sel;
+
 		if (fast_mode)
 		{
 			while (1) {
-				Pass::call(design, "opt_expr" + opt_expr_args);
-				Pass::call(design, "opt_merge" + opt_merge_args);
+				uint64_t round_start = RTLIL::Module::generation_counter;
+				call_on_round(design, round_sel.get(), "opt_expr" + opt_expr_args);
+				call_on_round(design, round_sel.get(), "opt_merge" + opt_merge_args);
 				design->scratchpad_unset("opt.did_something");
 				if (!noff_mode)
-					Pass::call(design, "opt_dff" + opt_dff_args);
+					call_on_round(design, round_sel.get(), "opt_dff" + opt_dff_args);
 				if (design->scratchpad_get_bool("opt.did_something") == false)
 					break;
-				Pass::call(design, "opt_clean" + opt_clean_args);
+				call_on_round(design, round_sel.get(), "opt_clean" + opt_clean_args);
+				round_sel.reset(new RTLIL::Selection(changed_selection(design, round_start)));
 				log_header(design, "Rerunning OPT passes. (Removed registers in this run.)\n");
 			}
 			Pass::call(design, "opt_clean" + opt_clean_args);
@@ -165,18 +210,20 @@ struct OptPass : public Pass {
 			Pass::call(design, "opt_expr" + opt_expr_args);
 			Pass::call(design, "opt_merge -nomux" + opt_merge_args);
 			while (1) {
+				uint64_t round_start = RTLIL::Module::generation_counter;
 				design->scratchpad_unset("opt.did_something");
-				Pass::call(design, "opt_muxtree");
-				Pass::call(design, "opt_reduce" + opt_reduce_args);
-				Pass::call(design, "opt_merge" + opt_merge_args);
+				call_on_round(design, round_sel.get(), "opt_muxtree");
+				call_on_round(design, round_sel.get(), "opt_reduce" + opt_reduce_args);
+				call_on_round(design, round_sel.get(), "opt_merge" + opt_merge_args);
 				if (opt_share)
-					Pass::call(design, "opt_share");
+					call_on_round(design, round_sel.get(), "opt_share");
 				if (!noff_mode)
-					Pass::call(design, "opt_dff" + opt_dff_args);
-				Pass::call(design, "opt_clean" + opt_clean_args);
-				Pass::call(design, "opt_expr" + opt_expr_args);
+					call_on_round(design, round_sel.get(), "opt_dff" + opt_dff_args);
+				call_on_round(design, round_sel.get(), "opt_clean" + opt_clean_args);
+				call_on_round(design, round_sel.get(), "opt_expr" + opt_expr_args);
 				if (design->scratchpad_get_bool("opt.did_something") == false)
 					break;
+				round_sel.reset(new RTLIL::Selection(changed_selection(design, round_start)));
 				log_header(design, "Rerunning OPT passes. (Maybe there is more to do..)\n");
 			}
 		}
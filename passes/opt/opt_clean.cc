@@ -106,7 +106,7 @@ int count_rm_cells, count_rm_wires;
 
 void rmunused_module_cells(Module *module, bool verbose)
 {
-	SigMap sigmap(module);
+	const SigMap &sigmap = module->sigmap();
 	dict<IdString, pool<Cell*>> mem2cells;
 	pool<IdString> mem_unused;
 	pool<Cell*> queue, unused;
@@ -317,7 +317,7 @@ bool rmunused_module_signals(RTLIL::Module *module, bool purge_mode, bool verbos
 				connected_signals.add(it2.second);
 		}
 
-	SigMap assign_map(module);
+	SigMap assign_map = module->sigmap();
 
 	// construct a pool of wires which are directly driven by a known celltype,
 	// this will influence our choice of representatives
@@ -350,6 +350,7 @@ bool rmunused_module_signals(RTLIL::Module *module, bool purge_mode, bool verbos
 
 	// we are removing all connections
 	module->connections_.clear();
+	module->touch();
 
 	// used signals sigmapped
 	SigPool used_signals;
@@ -519,7 +520,7 @@ bool rmunused_module_init(RTLIL::Module *module, bool verbose)
 	CellTypes fftypes;
 	fftypes.setup_internals_mem();
 
-	SigMap sigmap(module);
+	SigMap sigmap = module->sigmap();
 	dict<SigBit, State> qbits;
 
 	for (auto cell : module->cells())
@@ -588,8 +589,11 @@ bool rmunused_module_init(RTLIL::Module *module, bool verbose)
 	next_wire:;
 	}
 
-	if (did_something)
+	// Init attributes are written directly, so the module has to be marked as changed.
+	if (did_something) {
 		module->design->scratchpad_set_bool("opt.did_something", true);
+		module->touch();
+	}
 
 	return did_something;
 }
@@ -919,10 +919,14 @@ struct OptDffPass : public Pass {
 		bool did_something = false;
 		for (auto mod : design->selected_modules()) {
 			OptDffWorker worker(opt, mod);
-			if (worker.run())
-				did_something = true;
+			bool mod_changed = worker.run();
 			if (worker.run_constbits())
+				mod_changed = true;
+			// Some changes only rewrite cell types and parameters, which are not tracked.
+			if (mod_changed) {
+				mod->touch();
 				did_something = true;
+			}
 		}
 
 		if (did_something)
@@ -33,7 +33,7 @@ bool did_something;
 
 void replace_undriven(RTLIL::Module *module, const CellTypes &ct)
 {
-	SigMap sigmap(module);
+	SigMap sigmap = module->sigmap();
 	SigPool driven_signals;
 	SigPool used_signals;
 	SigPool all_signals;
@@ -94,7 +94,7 @@ void replace_undriven(RTLIL::Module *module, const CellTypes &ct)
 
 	if (!revisit_initwires.empty())
 	{
-		SigMap sm2(module);
+		const SigMap &sm2 = module->sigmap();
 
 		for (auto wire : revisit_initwires) {
 			SigSpec sig = sm2(wire);
@@ -395,7 +395,7 @@ int get_highest_hot_index(RTLIL::SigSpec signal)
 
 void replace_const_cells(RTLIL::Design *design, RTLIL::Module *module, bool consume_x, bool mux_undef, bool mux_bool, bool do_fine, bool keepdc, bool noclkinv)
 {
-	SigMap assign_map(module);
+	SigMap assign_map = module->sigmap();
 	dict<RTLIL::SigSpec, RTLIL::SigSpec> invert_map;
 
 	for (auto cell : module->cells()) {
@@ -2202,7 +2202,7 @@ skip_alu_split:
 }
 
 void replace_const_connections(RTLIL::Module *module) {
-	SigMap assign_map(module);
+	const SigMap &assign_map = module->sigmap();
 	for (auto cell : module->selected_cells())
 	{
 		std::vector<std::pair<RTLIL::IdString, SigSpec>> changes;
@@ -2311,27 +2311,35 @@ struct OptExprPass : public Pass {
 			if (undriven) {
 				did_something = false;
 				replace_undriven(module, ct);
-				if (did_something)
+				if (did_something) {
 					design->scratchpad_set_bool("opt.did_something", true);
+					module->touch();
+				}
 			}
 
 			do {
 				do {
 					did_something = false;
 					replace_const_cells(design, module, false /* consume_x */, mux_undef, mux_bool, do_fine, keepdc, noclkinv);
-					if (did_something)
+					if (did_something) {
 						design->scratchpad_set_bool("opt.did_something", true);
+						module->touch();
+					}
 				} while (did_something);
 				if (!keepdc)
 					replace_const_cells(design, module, true /* consume_x */, mux_undef, mux_bool, do_fine, keepdc, noclkinv);
-				if (did_something)
+				if (did_something) {
 					design->scratchpad_set_bool("opt.did_something", true);
+					module->touch();
+				}
 			} while (did_something);
 
 			did_something = false;
 			replace_const_connections(module);
-			if (did_something)
+			if (did_something) {
 				design->scratchpad_set_bool("opt.did_something", true);
+				module->touch();
+			}
 
 			log_suppressed();
 		}
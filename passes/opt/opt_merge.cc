@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <set>
+#include <atomic>
 
 
 USING_YOSYS_NAMESPACE
@@ -226,7 +227,7 @@ struct OptMergeWorker
 	}
 
 	OptMergeWorker(RTLIL::Design *design, RTLIL::Module *module, bool mode_nomux, bool mode_share_all, bool mode_keepdc) :
-		design(design), module(module), assign_map(module), mode_share_all(mode_share_all)
+		design(design), module(module), assign_map(module->sigmap()), mode_share_all(mode_share_all)
 	{
 		total_count = 0;
 		ct.setup_internals();
@@ -247,7 +248,6 @@ struct OptMergeWorker
 		ct.cell_types.erase(ID($allconst));
 
 		log("Finding identical cells in module `%s'.\n", module->name.c_str());
-		assign_map.set(module);
 
 		initvals.set(&assign_map, module);
 
@@ -313,8 +313,13 @@ struct OptMergeWorker
 	}
 };
 
-struct OptMergePass : public Pass {
-	OptMergePass() : Pass("opt_merge", "consolidate identical cells") { }
+struct OptMergePass : public ModulePass {
+	OptMergePass() : ModulePass("opt_merge", "consolidate identical cells") { }
+
+	RTLIL::Design *design;
+	bool mode_nomux, mode_share_all, mode_keepdc;
+	std::atomic<int> total_count;
+
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -334,13 +339,20 @@ struct OptMergePass : public Pass {
 		log("        Do not merge flipflops with don't-care bits in their initial value.\n");
 		log("\n");
 	}
+	void execute_module(RTLIL::Module *module) override
+	{
+		OptMergeWorker worker(design, module, mode_nomux, mode_share_all, mode_keepdc);
+		total_count += worker.total_count;
+	}
+
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
 		log_header(design, "Executing OPT_MERGE pass (detect identical cells).\n");
 
-		bool mode_nomux = false;
-		bool mode_share_all = false;
-		bool mode_keepdc = false;
+		this->design = design;
+		mode_nomux = false;
+		mode_share_all = false;
+		mode_keepdc = false;
 
 		size_t argidx;
 		for (argidx = 1; argidx < args.size(); argidx++) {
@@ -361,15 +373,12 @@ struct OptMergePass : public Pass {
 		}
 		extra_args(args, argidx, design);
 
-		int total_count = 0;
-		for (auto module : design->selected_modules()) {
-			OptMergeWorker worker(design, module, mode_nomux, mode_share_all, mode_keepdc);
-			total_count += worker.total_count;
-		}
+		total_count = 0;
+		run_on_modules(design->selected_modules());
 
 		if (total_count)
 			design->scratchpad_set_bool("opt.did_something", true);
-		log("Removed a total of %d cells.\n", total_count);
+		log("Removed a total of %d cells.\n", total_count.load());
 	}
 } OptMergePass;
 
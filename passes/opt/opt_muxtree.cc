@@ -495,6 +495,8 @@ struct OptMuxtreePass : public Pass {
 			if (module->has_processes_warn())
 				continue;
 			OptMuxtreeWorker worker(design, module);
+			if (worker.removed_count)
+				module->touch();
 			total_count += worker.removed_count;
 		}
 		if (total_count)
@@ -658,6 +658,7 @@ struct OptReducePass : public Pass {
 				total_count += worker.total_count;
 				if (worker.total_count == 0)
 					break;
+				module->touch();
 			}
 
 		if (total_count)
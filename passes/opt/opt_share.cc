@@ -552,6 +552,7 @@ struct OptSharePass : public Pass {
 					merged_ops.push_back(merged_op_t{mux, merged_ports, shared_operand});
 
 					design->scratchpad_set_bool("opt.did_something", true);
+					module->touch();
 				}
 
 			}
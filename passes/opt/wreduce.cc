@@ -51,7 +51,7 @@ struct WreduceWorker
 {
 	WreduceConfig *config;
 	Module *module;
-	ModIndex mi;
+	ModIndex &mi;
 
 	std::set<Cell*, IdString::compare_ptr_by_name<Cell>> work_queue_cells;
 	std::set<SigBit> work_queue_bits;
@@ -59,7 +59,7 @@ struct WreduceWorker
 	FfInitVals initvals;
 
 	WreduceWorker(WreduceConfig *config, Module *module) :
-			config(config), module(module), mi(module) { }
+			config(config), module(module), mi(module->index()) { }
 
 	void run_cell_mux(Cell *cell)
 	{
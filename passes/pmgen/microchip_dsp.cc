@@ -355,6 +355,8 @@ struct MicrochipDspPass : public Pass {
 				microchip_dsp_cascade_pm pm(module, module->selected_cells());
 				pm.run_microchip_dsp_cascade();
 			}
+			// The packers rewrite register and DSP ports in place
+			module->touch();
 		}
 	}
 } MicrochipDspPass;
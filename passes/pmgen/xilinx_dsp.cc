@@ -829,6 +829,8 @@ struct XilinxDspPass : public Pass {
 				xilinx_dsp_cascade_pm pm(module, module->selected_cells());
 				pm.run_xilinx_dsp_cascade();
 			}
+			// The packers rewrite register and DSP ports in place
+			module->touch();
 		}
 	}
 } XilinxDspPass;
@@ -251,6 +251,7 @@ struct XilinxSrlPass : public Pass {
 				pm.run_fixed(run_fixed);
 			if (variable)
 				pm.run_variable(run_variable);
+			module->touch();
 		}
 	}
 } XilinxSrlPass;
@@ -502,6 +502,7 @@ struct ExposePass : public Pass {
 
 				for (auto &conn : module->connections_)
 					conn.first = out_to_in_map(conn.first);
+				module->touch();
 			}
 
 			if (flag_cut)
@@ -523,6 +524,7 @@ struct ExposePass : public Pass {
 
 				for (auto &conn : module->connections_)
 					conn.second = out_to_in_map(sigmap(conn.second));
+				module->touch();
 			}
 
 			std::set<RTLIL::SigBit> set_q_bits;
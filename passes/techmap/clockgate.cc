@@ -212,7 +212,9 @@ struct ClockgatePass : public Pass {
 		log("        If specified, ICGs will be selected from the liberty files\n");
 		log("        if available. Priority is given to cells with fewer tie_lo\n");
 		log("        inputs and smaller size. This removes the need to manually\n");
-		log("        specify -pos or -neg and -tie_lo.\n");
+		log("        specify -pos or -neg and -tie_lo. The parsed files are cached\n");
+		log("        in the directory given by the scratchpad variable liberty.cache,\n");
+		log("        if set.\n");
 		log("    -dont_use <celltype>\n");
 		log("        Cells <celltype> won't be considered when searching for ICGs\n");
 		log("        in the liberty file specified by -liberty.\n");
@@ -312,7 +314,7 @@ struct ClockgatePass : public Pass {
 				f.open(path.c_str());
 				if (f.fail())
 					log_cmd_error("Can't open liberty file `%s': %s\n", path.c_str(), strerror(errno));
-				LibertyParser p(f);
+				LibertyParser p(f, path, LibertyParser::pin_tables);
 				merged.merge(p);
 				f.close();
 			}
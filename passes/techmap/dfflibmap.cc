@@ -572,6 +572,9 @@ struct DfflibmapPass : public Pass {
 		log("This argument can be called multiple times with different cell names. This\n");
 		log("argument also supports simple glob patterns in the cell name.\n");
 		log("\n");
+		log("The parsed liberty files are cached in the directory given by the scratchpad\n");
+		log("variable liberty.cache, if set (see 'help scratchpad').\n");
+		log("\n");
 	}
 	void execute(std::vector<std::string> args, RTLIL::Design *design) override
 	{
@@ -634,7 +637,7 @@ struct DfflibmapPass : public Pass {
 			f.open(path.c_str());
 			if (f.fail())
 				log_cmd_error("Can't open liberty file `%s': %s\n", path.c_str(), strerror(errno));
-			LibertyParser p(f);
+			LibertyParser p(f, path, LibertyParser::pin_tables);
 			merged.merge(p);
 			f.close();
 		}
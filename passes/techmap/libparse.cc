@@ -28,6 +28,13 @@
 
 #ifndef FILTERLIB
 #include "kernel/log.h"
+#include "libs/sha1/sha1.h"
+#  if !defined(_WIN32)
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <fcntl.h>
+#    include <unistd.h>
+#  endif
 #endif
 
 using namespace Yosys;
@@ -516,6 +523,280 @@ void LibertyParser::error(const std::string &str) const
 	log_error("%s", ss.str().c_str());
 }
 
+// The cache of parsed liberty files is a directory with a binary copy of the tree
+// of each file, named after the hash of the contents of the file. A copy is the
+// magic, the top node and the table of all the strings, with the offset of the
+// table in the last 8 bytes. A node is its id and the size of the rest, so that a
+// filtered load can step over it, then the value, the args and the children. All
+// the numbers are varints like in the binary RTLIL, the strings are indices into
+// the table.
+
+const pool<std::string> LibertyParser::pin_tables = {"timing", "internal_power", "leakage_power"};
+
+static const char liberty_cache_magic[8] = {'\0', 'L', 'I', 'B', 'E', 'R', 'b', '1'};
+
+namespace {
+
+struct LibertyCacheWriter
+{
+	dict<std::string, int> string_index;
+	std::vector<std::string> strings;
+
+	static void put_uint(std::string &buf, uint64_t value)
+	{
+		while (value >= 0x80) {
+			buf.push_back(char(value | 0x80));
+			value >>= 7;
+		}
+		buf.push_back(char(value));
+	}
+
+	void put_string(std::string &buf, const std::string &str)
+	{
+		auto it = string_index.find(str);
+		if (it == string_index.end()) {
+			it = string_index.emplace(str, GetSize(strings)).first;
+			strings.push_back(str);
+		}
+		put_uint(buf, it->second);
+	}
+
+	void put_node(std::string &buf, const LibertyAst *ast)
+	{
+		std::string body;
+		put_string(body, ast->value);
+		put_uint(body, ast->args.size());
+		for (auto &arg : ast->args)
+			put_string(body, arg);
+		put_uint(body, ast->children.size());
+		for (auto child : ast->children)
+			put_node(body, child);
+
+		put_string(buf, ast->id);
+		put_uint(buf, body.size());
+		buf.append(body);
+	}
+
+	std::string write(const LibertyAst *ast)
+	{
+		std::string buf(liberty_cache_magic, sizeof(liberty_cache_magic));
+		put_node(buf, ast);
+
+		uint64_t table_offset = buf.size();
+		put_uint(buf, strings.size());
+		for (auto &str : strings) {
+			put_uint(buf, str.size());
+			buf.append(str);
+		}
+		for (int i = 0; i < 8; i++)
+			buf.push_back(char(table_offset >> (8*i)));
+		return buf;
+	}
+};
+
+// Reads the copy mapped into memory, and gives up on the first inconsistency, in
+// which case the file is parsed again.
+struct LibertyCacheReader
+{
+	const char *ptr = nullptr, *end = nullptr;
+	std::vector<std::string> strings;
+	const pool<std::string> &skip;
+	bool failed = false;
+
+	LibertyCacheReader(const pool<std::string> &skip) : skip(skip) { }
+
+	uint64_t get_uint()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; shift < 64; shift += 7) {
+			if (ptr == end) {
+				failed = true;
+				return 0;
+			}
+			uint8_t byte = *ptr++;
+			value |= uint64_t(byte & 0x7f) << shift;
+			if (!(byte & 0x80))
+				return value;
+		}
+		failed = true;
+		return 0;
+	}
+
+	const std::string &get_string()
+	{
+		static const std::string empty;
+		uint64_t index = get_uint();
+		if (index >= strings.size()) {
+			failed = true;
+			return empty;
+		}
+		return strings[index];
+	}
+
+	// Returns nullptr for a node that is skipped, and on failure
+	LibertyAst *get_node(bool top)
+	{
+		const std::string &id = get_string();
+		uint64_t size = get_uint();
+		if (failed || size > uint64_t(end - ptr)) {
+			failed = true;
+			return nullptr;
+		}
+		if (!top && skip.count(id)) {
+			ptr += size;
+			return nullptr;
+		}
+
+		LibertyAst *ast = new LibertyAst;
+		ast->id = id;
+		ast->value = get_string();
+		uint64_t num_args = get_uint();
+		for (uint64_t i = 0; i < num_args && !failed; i++)
+			ast->args.push_back(get_string());
+		uint64_t num_children = get_uint();
+		for (uint64_t i = 0; i < num_children && !failed; i++) {
+			LibertyAst *child = get_node(false);
+			if (child != nullptr)
+				ast->children.push_back(child);
+		}
+		if (failed) {
+			delete ast;
+			return nullptr;
+		}
+		return ast;
+	}
+
+	LibertyAst *read(const char *data, size_t size)
+	{
+		if (size < sizeof(liberty_cache_magic) + 8 || memcmp(data, liberty_cache_magic, sizeof(liberty_cache_magic)))
+			return nullptr;
+
+		uint64_t table_offset = 0;
+		for (int i = 0; i < 8; i++)
+			table_offset |= uint64_t(uint8_t(data[size - 8 + i])) << (8*i);
+		if (table_offset < sizeof(liberty_cache_magic) || table_offset > size - 8)
+			return nullptr;
+
+		ptr = data + table_offset;
+		end = data + size - 8;
+		uint64_t num_strings = get_uint();
+		for (uint64_t i = 0; i < num_strings && !failed; i++) {
+			uint64_t len = get_uint();
+			if (failed || len > uint64_t(end - ptr)) {
+				failed = true;
+				break;
+			}
+			strings.emplace_back(ptr, len);
+			ptr += len;
+		}
+		if (failed)
+			return nullptr;
+
+		ptr = data + sizeof(liberty_cache_magic);
+		end = data + table_offset;
+		return get_node(true);
+	}
+};
+
+}
+
+static LibertyAst *liberty_cache_load(const std::string &filename, const pool<std::string> &skip)
+{
+	LibertyCacheReader reader(skip);
+	LibertyAst *ast = nullptr;
+#if !defined(_WIN32)
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return nullptr;
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+		void *mapped = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (mapped != MAP_FAILED) {
+			ast = reader.read(static_cast<const char*>(mapped), st.st_size);
+			munmap(mapped, st.st_size);
+		}
+	}
+	close(fd);
+#else
+	std::ifstream f(filename, std::ios::binary);
+	if (f.fail())
+		return nullptr;
+	std::stringstream ss;
+	ss << f.rdbuf();
+	std::string buffer = ss.str();
+	ast = reader.read(buffer.data(), buffer.size());
+#endif
+	return ast;
+}
+
+static void liberty_cache_store(const std::string &filename, const LibertyAst *ast)
+{
+	std::string dir = filename.substr(0, filename.rfind('/'));
+	if (!create_directory(dir)) {
+		log_warning("Can't create liberty cache directory `%s'.\n", dir.c_str());
+		return;
+	}
+
+	// Written under a temporary name, so that other runs never see a partial file
+	std::string temp_filename = make_temp_file(dir + "/liberty_XXXXXX");
+	std::ofstream f(temp_filename, std::ios::binary);
+	LibertyCacheWriter writer;
+	std::string buf = writer.write(ast);
+	f.write(buf.data(), buf.size());
+	f.close();
+
+#if !defined(_WIN32)
+	// mkstemp() creates the file as 0600, but the cache should be as readable as any other output
+	mode_t mask = umask(0);
+	umask(mask);
+	chmod(temp_filename.c_str(), 0644 & ~mask);
+#endif
+
+	if (f.fail() || rename(temp_filename.c_str(), filename.c_str()) != 0) {
+		log_warning("Can't write liberty cache file `%s'.\n", filename.c_str());
+		remove(temp_filename.c_str());
+	}
+}
+
+static void liberty_skip(LibertyAst *ast, const pool<std::string> &skip)
+{
+	std::vector<LibertyAst*> children;
+	for (auto child : ast->children)
+		if (skip.count(child->id))
+			delete child;
+		else {
+			liberty_skip(child, skip);
+			children.push_back(child);
+		}
+	ast->children.swap(children);
+}
+
+LibertyParser::LibertyParser(std::istream &f, const std::string &fname, const pool<std::string> &skip) : f(f), line(1), ast(nullptr)
+{
+	RTLIL::Design *design = yosys_get_design();
+	std::string dir = design != nullptr ? design->scratchpad_get_string("liberty.cache") : std::string();
+	std::string cache_filename;
+	if (!dir.empty() && check_file_exists(fname))
+		cache_filename = dir + "/" + SHA1::from_file(fname) + ".bin";
+
+	if (!cache_filename.empty()) {
+		ast = liberty_cache_load(cache_filename, skip);
+		if (ast != nullptr) {
+			log("Loaded liberty file `%s' from cache file `%s'.\n", fname.c_str(), cache_filename.c_str());
+			return;
+		}
+	}
+
+	LibertyAst *tree = parse();
+	if (tree != nullptr) {
+		if (!cache_filename.empty())
+			liberty_cache_store(cache_filename, tree);
+		if (!skip.empty())
+			liberty_skip(tree, skip);
+	}
+	ast = tree;
+}
+
 #else
 
 void LibertyParser::error() const
@@ -109,7 +109,19 @@ namespace Yosys
 		const LibertyAst *ast;
 
 		LibertyParser(std::istream &f) : f(f), line(1), ast(parse()) {}
+#ifndef FILTERLIB
+		// Loads the tree of the file fname from the cache directory set with the
+		// scratchpad variable liberty.cache when it holds a copy for the same
+		// contents, and parses f (and stores the tree there) otherwise. Groups
+		// and attributes with an id in skip are left out at any depth below the
+		// library, which lets a pass load only the part of the library it needs.
+		LibertyParser(std::istream &f, const std::string &fname, const pool<std::string> &skip = {});
+#endif
 		~LibertyParser() { if (ast) delete ast; }
+
+		// the timing and power tables of the pins, which are most of the size of
+		// a library but not used for mapping to its cells
+		static const pool<std::string> pin_tables;
 	};
 
 	class LibertyMergedCells
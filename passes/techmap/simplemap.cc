@@ -470,8 +470,12 @@ void simplemap(RTLIL::Module *module, RTLIL::Cell *cell)
 YOSYS_NAMESPACE_END
 PRIVATE_NAMESPACE_BEGIN
 
-struct SimplemapPass : public Pass {
-	SimplemapPass() : Pass("simplemap", "mapping simple coarse-grain cells") { }
+struct SimplemapPass : public ModulePass {
+	SimplemapPass() : ModulePass("simplemap", "mapping simple coarse-grain cells") { }
+
+	RTLIL::Design *design;
+	dict<IdString, void(*)(RTLIL::Module*, RTLIL::Cell*)> mappers;
+
 	void help() override
 	{
 		//   |---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|---v---|
@@ -493,22 +497,28 @@ struct SimplemapPass : public Pass {
 		log_header(design, "Executing SIMPLEMAP pass (map simple cells to gate primitives).\n");
 		extra_args(args, 1, design);
 
-		dict<IdString, void(*)(RTLIL::Module*, RTLIL::Cell*)> mappers;
-		simplemap_get_mappers(mappers);
+		this->design = design;
+		if (mappers.empty())
+			simplemap_get_mappers(mappers);
+
+		std::vector<RTLIL::Module*> modules;
+		for (auto mod : design->modules())
+			if (design->selected(mod) && !mod->get_blackbox_attribute())
+				modules.push_back(mod);
+		run_on_modules(modules);
+	}
 
-		for (auto mod : design->modules()) {
-			if (!design->selected(mod) || mod->get_blackbox_attribute())
+	void execute_module(RTLIL::Module *mod) override
+	{
+		std::vector<RTLIL::Cell*> cells = mod->cells();
+		for (auto cell : cells) {
+			if (mappers.count(cell->type) == 0)
 				continue;
-			std::vector<RTLIL::Cell*> cells = mod->cells();
-			for (auto cell : cells) {
-				if (mappers.count(cell->type) == 0)
-					continue;
-				if (!design->selected(mod, cell))
-					continue;
-				log("Mapping %s.%s (%s).\n", log_id(mod), log_id(cell), log_id(cell->type));
-				mappers.at(cell->type)(mod, cell);
-				mod->remove(cell);
-			}
+			if (!design->selected(mod, cell))
+				continue;
+			log("Mapping %s.%s (%s).\n", log_id(mod), log_id(cell), log_id(cell->type));
+			mappers.at(cell->type)(mod, cell);
+			mod->remove(cell);
 		}
 	}
 } SimplemapPass;
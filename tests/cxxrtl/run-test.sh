@@ -15,3 +15,14 @@ run_subtest value_fuzz
 # Compile-only test.
 ../../yosys -p "read_verilog test_unconnected_output.v; proc; clean; write_cxxrtl cxxrtl-test-unconnected_output.cc"
 ${CC:-gcc} -std=c++11 -c -o cxxrtl-test-unconnected_output -I../../backends/cxxrtl/runtime cxxrtl-test-unconnected_output.cc
+
+# Test of the per-module files, linked together with a driver.
+rm -rf cxxrtl-test-split
+mkdir cxxrtl-test-split
+../../yosys -p "read_verilog test_split.v; write_cxxrtl -noflatten -split cxxrtl-test-split/model cxxrtl-test-split/main.cc"
+for cc in cxxrtl-test-split/main.cc cxxrtl-test-split/model/*.cc; do
+    ${CC:-gcc} -std=c++11 -c -o ${cc%.cc}.o -I../../backends/cxxrtl/runtime $cc
+done
+${CC:-gcc} -std=c++11 -o cxxrtl-test-split/driver -I. -I../../backends/cxxrtl/runtime test_split.cc \
+    cxxrtl-test-split/main.o cxxrtl-test-split/model/*.o -lstdc++
+./cxxrtl-test-split/driver
@@ -0,0 +1,20 @@
+#include <cassert>
+#include <cstdint>
+
+#include "cxxrtl-test-split/model/cxxrtl_design.h"
+
+// Driver for the per-module files written by `write_cxxrtl -split`, linked with them
+// to check that every module is defined exactly once.
+int main()
+{
+    cxxrtl_design::p_split__top top;
+    for (int i = 0; i < 5; i++) {
+        top.p_clk.set(false);
+        top.step();
+        top.p_clk.set(true);
+        top.step();
+    }
+    assert(top.p_q.get<uint8_t>() == 5);
+    assert(top.p_z.get<uint8_t>() == uint8_t(~5));
+    return 0;
+}
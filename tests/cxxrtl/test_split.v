@@ -0,0 +1,19 @@
+module split_sub(
+    input  [7:0] a,
+    output [7:0] y
+);
+    assign y = ~a;
+endmodule
+
+module split_top(
+    input            clk,
+    output reg [7:0] q,
+    output     [7:0] z
+);
+    always @(posedge clk)
+        q <= q + 1;
+    split_sub u_sub (
+        .a (q),
+        .y (z)
+    );
+endmodule
@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include "kernel/yosys.h"
+#include "kernel/sigtools.h"
+
+#include <chrono>
+#include <map>
+#include <random>
+
+YOSYS_NAMESPACE_BEGIN
+
+// These tests hold for both hashlib backends (see ENABLE_HASHLIB_SWISS in the Makefile).
+
+TEST(KernelHashlibTest, dictInsertionOrder)
+{
+	dict<int, int> d;
+	for (int i = 0; i < 1000; i++)
+		d[(i * 7919) % 1000] = i;
+
+	// Iteration goes from the most recently inserted entry to the oldest one
+	int i = 999;
+	for (auto &it : d) {
+		EXPECT_EQ(it.first, (i * 7919) % 1000);
+		EXPECT_EQ(it.second, i);
+		i--;
+	}
+	EXPECT_EQ(i, -1);
+
+	// Erasing moves the newest entry into the hole
+	d.erase((500 * 7919) % 1000);
+	EXPECT_EQ(d.size(), 999u);
+	EXPECT_EQ(d.element(998 - 500)->second, 999);
+	EXPECT_EQ(d.count((500 * 7919) % 1000), 0);
+}
+
+TEST(KernelHashlibTest, idictIndices)
+{
+	idict<std::string> id;
+	for (int i = 0; i < 1000; i++)
+		EXPECT_EQ(id(std::to_string(i)), i);
+	for (int i = 999; i >= 0; i--)
+		EXPECT_EQ(id(std::to_string(i)), i);
+	EXPECT_EQ(id.at("1000", -1), -1);
+	EXPECT_EQ(id[123], "123");
+}
+
+TEST(KernelHashlibTest, dictRandomOps)
+{
+	std::mt19937 rng(1);
+	dict<int, int> d;
+	pool<int> p;
+	std::map<int, int> ref;
+
+	for (int iter = 0; iter < 200000; iter++) {
+		int key = rng() % 5000;
+		switch (rng() % 4) {
+		case 0:
+		case 1:
+			d[key] = iter;
+			p.insert(key);
+			ref[key] = iter;
+			break;
+		case 2:
+			EXPECT_EQ(d.erase(key), int(ref.erase(key)));
+			p.erase(key);
+			break;
+		default:
+			EXPECT_EQ(d.count(key), int(ref.count(key)));
+			EXPECT_EQ(p.count(key), int(ref.count(key)));
+			if (ref.count(key))
+				EXPECT_EQ(d.at(key), ref.at(key));
+		}
+		if (iter % 50000 == 0) {
+			dict<int, int> copy = d;
+			EXPECT_TRUE(copy == d);
+			copy.sort();
+			EXPECT_TRUE(copy == d);
+		}
+	}
+	EXPECT_EQ(d.size(), ref.size());
+	EXPECT_EQ(p.size(), ref.size());
+}
+
+// Comparing the backends: build once with each ENABLE_HASHLIB_SWISS setting and run
+//   bintest/kernel/hashlibTest --gtest_also_run_disabled_tests --gtest_filter='KernelHashlibBench.*'
+// The workload is a large generated netlist going through SigMap construction,
+// opt_clean and sim, which are dominated by dict/pool operations on SigBits and cells.
+TEST(KernelHashlibBench, DISABLED_netlistWorkloads)
+{
+	const int num_cells = 200000;
+	yosys_setup();
+	log_streams.clear();
+
+	RTLIL::Design *design = new RTLIL::Design;
+	RTLIL::Module *module = design->addModule(ID(top));
+	RTLIL::Wire *clk = module->addWire(ID(clk));
+	clk->port_input = true;
+	module->fixup_ports();
+
+	std::mt19937 rng(1);
+	std::vector<RTLIL::SigSpec> sigs;
+	for (int i = 0; i < 64; i++) {
+		RTLIL::Wire *q = module->addWire(NEW_ID, 8);
+		q->attributes[ID::init] = RTLIL::Const(i, 8);
+		sigs.push_back(q);
+	}
+	for (int i = 0; i < num_cells; i++) {
+		RTLIL::SigSpec a = sigs[rng() % sigs.size()], b = sigs[rng() % sigs.size()];
+		RTLIL::SigSpec y = (i % 3) ? module->Xor(NEW_ID, a, b) : module->And(NEW_ID, a, b);
+		if (i % 97 == 0) {
+			RTLIL::Wire *q = module->addWire(NEW_ID, 8);
+			q->attributes[ID::init] = RTLIL::Const(0, 8);
+			module->addDff(NEW_ID, clk, y, q);
+			y = q;
+		}
+		sigs.push_back(y);
+	}
+
+	auto time = [](const char *what, std::function<void()> f) {
+		auto start = std::chrono::steady_clock::now();
+		f();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		printf("%-24s %8.3f s\n", what, elapsed.count());
+	};
+
+	time("SigMap + pool<SigBit>", [&]() {
+		for (int i = 0; i < 5; i++) {
+			SigMap sigmap(module);
+			pool<RTLIL::SigBit> used;
+			for (auto cell : module->cells())
+				for (auto &conn : cell->connections())
+					for (auto bit : sigmap(conn.second))
+						used.insert(bit);
+		}
+	});
+	time("sim -n 20", [&]() { Pass::call(design, "sim -clock clk -n 20"); });
+	time("opt_clean", [&]() { Pass::call(design, "opt_clean"); });
+
+	delete design;
+	yosys_shutdown();
+}
+
+YOSYS_NAMESPACE_END
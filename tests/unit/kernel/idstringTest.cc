@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include "kernel/rtlil.h"
+
+#include <chrono>
+#ifdef YOSYS_ENABLE_THREADS
+#include <thread>
+#endif
+
+YOSYS_NAMESPACE_BEGIN
+
+// These tests hold with and without ENABLE_THREADS (see the Makefile).
+
+TEST(KernelIdStringTest, interning)
+{
+	RTLIL::IdString a("\\idstring_test_a"), b(std::string("\\idstring_test_a")), c("$idstring_test_c");
+	EXPECT_EQ(a, b);
+	EXPECT_EQ(a.index_, b.index_);
+	EXPECT_NE(a, c);
+	EXPECT_STREQ(a.c_str(), "\\idstring_test_a");
+	EXPECT_EQ(c.str(), "$idstring_test_c");
+	EXPECT_TRUE(RTLIL::IdString().empty());
+}
+
+TEST(KernelIdStringTest, release)
+{
+	int index;
+	{
+		RTLIL::IdString a("\\idstring_test_release");
+		RTLIL::IdString b = a;
+		index = a.index_;
+	}
+	RTLIL::IdString::checkpoint();
+
+	// The index is free and its name is no longer interned
+	RTLIL::IdString a("\\idstring_test_release");
+	EXPECT_STREQ(a.c_str(), "\\idstring_test_release");
+	RTLIL::IdString b("\\idstring_test_other");
+	EXPECT_NE(a.index_, b.index_);
+	EXPECT_TRUE(a.index_ == index || b.index_ == index);
+}
+
+#ifdef YOSYS_ENABLE_THREADS
+TEST(KernelIdStringTest, concurrentInterning)
+{
+	const int num_threads = 8, num_ids = 20000;
+	std::vector<std::vector<int>> indices(num_threads);
+	std::vector<std::vector<RTLIL::IdString>> kept(num_threads);
+	std::vector<std::thread> threads;
+	yosys_threads_running = true;
+	for (int t = 0; t < num_threads; t++)
+		threads.emplace_back([&, t]() {
+			for (int i = 0; i < num_ids; i++) {
+				RTLIL::IdString id(stringf("\\idstring_test_%d", i));
+				RTLIL::IdString tmp(stringf("$idstring_test_%d_%d", t, i));
+				kept[t].push_back(id);
+				indices[t].push_back(id.index_);
+			}
+			if (t % 2)
+				RTLIL::IdString::checkpoint();
+		});
+	for (auto &thread : threads)
+		thread.join();
+	yosys_threads_running = false;
+
+	for (int t = 1; t < num_threads; t++)
+		EXPECT_EQ(indices[t], indices[0]);
+	RTLIL::IdString::checkpoint();
+	for (int i = 0; i < num_ids; i += 997)
+		EXPECT_EQ(RTLIL::IdString(stringf("\\idstring_test_%d", i)).str(), stringf("\\idstring_test_%d", i));
+}
+#endif
+
+// Single-threaded cost of the cache: build once with each ENABLE_THREADS setting and run
+//   bintest/kernel/idstringTest --gtest_also_run_disabled_tests --gtest_filter='KernelIdStringBench.*'
+TEST(KernelIdStringBench, DISABLED_singleThreaded)
+{
+	const int num_ids = 200000, num_rounds = 10;
+	std::vector<std::string> names;
+	for (int i = 0; i < num_ids; i++)
+		names.push_back(stringf("$auto$idstring_bench.cc:%d", i));
+
+	auto time = [](const char *what, std::function<void()> f) {
+		auto start = std::chrono::steady_clock::now();
+		f();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		printf("%-24s %8.3f s\n", what, elapsed.count());
+	};
+
+	std::vector<RTLIL::IdString> ids;
+	time("create", [&]() {
+		for (auto &name : names)
+			ids.push_back(name);
+	});
+	time("lookup", [&]() {
+		for (int r = 0; r < num_rounds; r++)
+			for (auto &name : names)
+				RTLIL::IdString id(name);
+	});
+	time("copy", [&]() {
+		for (int r = 0; r < num_rounds; r++) {
+			std::vector<RTLIL::IdString> copy = ids;
+		}
+	});
+	size_t total = 0;
+	time("c_str", [&]() {
+		for (int r = 0; r < num_rounds; r++)
+			for (auto &id : ids)
+				total += id.c_str()[1];
+	});
+	EXPECT_NE(total, 0u);
+	time("release", [&]() {
+		ids.clear();
+		RTLIL::IdString::checkpoint();
+	});
+}
+
+YOSYS_NAMESPACE_END
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "kernel/yosys.h"
+
+YOSYS_NAMESPACE_BEGIN
+
+namespace {
+	struct AddWiresPass : ModulePass {
+		AddWiresPass() : ModulePass("test_add_wires") { }
+
+		void execute(std::vector<std::string>, RTLIL::Design *design) override
+		{
+			run_on_modules(design->selected_modules());
+		}
+
+		void execute_module(RTLIL::Module *module) override
+		{
+			int count = GetSize(module->wires()) % 7 + 1;
+			for (int i = 0; i < count; i++)
+				module->addWire(NEW_ID);
+			RTLIL::Wire *wire = module->addWire(NEW_ID_SUFFIX("extra"));
+			RTLIL::Memory proto;
+			RTLIL::Memory *memory = module->addMemory(NEW_ID, &proto);
+			log("Added %d wires to %s, and %s and %s.\n", count, log_id(module), log_id(wire), log_id(memory));
+			if (count == 3)
+				log_warning("Module %s got 3 wires.\n", log_id(module));
+		}
+	};
+
+	std::string run_with_jobs(int jobs)
+	{
+		RTLIL::Design design;
+		for (int i = 0; i < 16; i++) {
+			RTLIL::Module *module = design.addModule(stringf("\\m%d", i));
+			for (int j = 0; j < i * 5; j++)
+				module->addWire(stringf("\\w%d", j));
+		}
+
+		std::stringstream buf;
+		log_streams.push_back(&buf);
+		int bak_yosys_jobs = yosys_jobs;
+		yosys_jobs = jobs;
+		autoidx = 1;
+
+		AddWiresPass pass;
+		pass.execute({}, &design);
+
+		yosys_jobs = bak_yosys_jobs;
+		log_streams.pop_back();
+
+		for (auto module : design.modules()) {
+			for (auto wire : module->wires())
+				buf << module->name.str() << " " << wire->name.str() << "\n";
+			for (auto &it : module->memories)
+				buf << module->name.str() << " " << it.first.str() << "\n";
+		}
+		buf << "autoidx " << autoidx << "\n";
+		return buf.str();
+	}
+}
+
+TEST(KernelModulePassTest, independentOfJobs)
+{
+	// Each module gets its wires, one suffixed wire and one memory
+	int expected_autoidx = 1;
+	for (int i = 0; i < 16; i++)
+		expected_autoidx += (i * 5) % 7 + 1 + 2;
+
+	std::string serial = run_with_jobs(1);
+	EXPECT_NE(serial.find(stringf("autoidx %d\n", expected_autoidx)), std::string::npos);
+	EXPECT_EQ(serial, run_with_jobs(4));
+}
+
+YOSYS_NAMESPACE_END
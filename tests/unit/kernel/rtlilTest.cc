@@ -29,6 +29,12 @@ namespace RTLIL {
 			EXPECT_TRUE(c1.is_str());
 			EXPECT_TRUE(c2.is_str());
 			EXPECT_TRUE(c3.is_str());
+
+			// Equal strings share one interned entry
+			Const c4 = std::string("foo");
+			EXPECT_EQ(c1.str_, c4.str_);
+			EXPECT_EQ(c1.str_->second, 4);
+			EXPECT_TRUE(c1 == c4);
 		}
 
 		{
@@ -74,6 +80,38 @@ namespace RTLIL {
 		}
 
 	}
+
+	TEST_F(KernelRtlilTest, ConstCalcWide) {
+		// Crosses the 64-bit word boundary of the packed kernels
+		Const ones(State::S1, 70);
+		Const x_msb = ones;
+		x_msb.bits().back() = State::Sx;
+		EXPECT_EQ(const_and(ones, Const(State::S0, 70), false, false, -1), Const(State::S0, 70));
+		EXPECT_EQ(const_not(x_msb, Const(), false, false, -1).as_string(), "x" + std::string(69, '0'));
+		EXPECT_EQ(const_xor(x_msb, ones, false, false, 72).as_string(), "00x" + std::string(69, '0'));
+		EXPECT_EQ(const_reduce_and(x_msb, Const(), false, false, 1), Const(State::Sx));
+		EXPECT_EQ(const_reduce_or(x_msb, Const(), false, false, 1), Const(State::S1));
+		EXPECT_EQ(const_reduce_xor(ones, Const(), false, false, 1), Const(State::S0));
+		EXPECT_EQ(const_eq(x_msb, ones, false, false, 1), Const(State::Sx));
+		EXPECT_EQ(const_eq(x_msb, Const(State::S0, 70), false, false, 1), Const(State::S0));
+
+		// Signed extension of a narrow operand
+		EXPECT_EQ(const_or(Const(State::S1, 1), Const(State::S0, 70), true, false, -1), ones);
+
+		// Arithmetic in and beyond the 64-bit fast path
+		EXPECT_EQ(const_add(Const(-3, 8), Const(5, 8), true, true, 16), Const(2, 16));
+		EXPECT_EQ(const_mul(Const(-3, 8), Const(5, 8), true, true, 16), Const(-15, 16));
+		EXPECT_EQ(const_div(Const(-7, 8), Const(2, 8), true, true, 8), Const(-3, 8));
+		EXPECT_EQ(const_mod(Const(-7, 8), Const(2, 8), true, true, 8), Const(-1, 8));
+		EXPECT_EQ(const_lt(Const(-1, 8), Const(1, 8), true, true, 1), Const(State::S1));
+		EXPECT_EQ(const_lt(Const(-1, 8), Const(1, 8), false, false, 1), Const(State::S0));
+		EXPECT_EQ(const_add(ones, Const(1, 2), false, false, 71).as_string(), "1" + std::string(70, '0'));
+		EXPECT_EQ(const_sub(Const(State::S0, 1), x_msb, false, false, 4), Const(State::Sx, 4));
+
+		// Shift amounts far beyond the operand width
+		EXPECT_EQ(const_shl(ones, Const(State::S1, 40), false, false, 70), Const(State::S0, 70));
+		EXPECT_EQ(const_sshr(ones, Const(1000, 32), true, false, 70), ones);
+	}
 }
 
 YOSYS_NAMESPACE_END
@@ -0,0 +1,31 @@
+#!/usr/bin/env bash
+set -e
+
+../../yosys -q -p "
+read_verilog taint_coverage.v
+hierarchy -top taint_coverage_top; proc
+cellift -exclude-signals clk
+taint_coverage -clear -index taint_coverage.json
+select -assert-count 1 taint_coverage_sub/i:taint_cov_clear
+select -assert-count 1 taint_coverage_top/c:u %x:+[taint_cov_clear] taint_coverage_top/i:taint_cov_clear %i
+write_rtlil taint_coverage.il
+"
+
+# Find the bits of the register of the toplevel and of the submodule in the index
+python3 - <<'PY'
+import json
+index = json.load(open("taint_coverage.json"))["modules"]["taint_coverage_top"]
+assert index["port"] == "taint_cov" and index["width"] == 2, index
+top_bits = [i for i, name in enumerate(index["bits"]) if not name.startswith("u.")]
+sub_bits = [i for i, name in enumerate(index["bits"]) if name.startswith("u.")]
+assert len(top_bits) == 1 and len(sub_bits) == 1, index
+with open("taint_coverage.vh", "w") as f:
+    f.write("`define TOP_BIT %d\n`define SUB_BIT %d\n" % (top_bits[0], sub_bits[0]))
+PY
+
+../../yosys -q -p "
+read_rtlil taint_coverage.il
+read_verilog -formal taint_coverage_tb.v
+hierarchy -top taint_coverage_tb; proc; chformal -lower; flatten
+sim -clock clk -zinit -n 14 -assert
+"
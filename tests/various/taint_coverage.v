@@ -0,0 +1,8 @@
+module taint_coverage_sub(input clk, input [1:0] a, output reg [1:0] q);
+  always @(posedge clk) q <= a;
+endmodule
+
+module taint_coverage_top(input clk, input [1:0] a, input b, output [1:0] q, output reg r);
+  taint_coverage_sub u(.clk(clk), .a(a), .q(q));
+  always @(posedge clk) r <= b;
+endmodule
@@ -0,0 +1,19 @@
+// The bits of taint_cov given by the index, written by taint_coverage.sh
+`include "taint_coverage.vh"
+
+module taint_coverage_tb(input clk);
+  reg [3:0] cyc = 0;
+  always @(posedge clk) cyc <= cyc + 1;
+
+  wire [1:0] q, q_t0, taint_cov;
+  wire r, r_t0;
+  taint_coverage_top dut(.clk(clk), .a(2'b00), .a_t0(cyc == 5 ? 2'b01 : 2'b00), .b(1'b0), .b_t0(cyc == 1),
+      .q(q), .q_t0(q_t0), .r(r), .r_t0(r_t0), .taint_cov(taint_cov), .taint_cov_clear(cyc == 9));
+
+  // The taint of b reaches r_t0 at cycle 2 and that of a reaches q_t0 at cycle 6.
+  // The sticky bits follow one cycle later, and stay set until the clear at cycle 9.
+  always @* begin
+    assert(taint_cov[`TOP_BIT] == (cyc >= 3 && cyc <= 9));
+    assert(taint_cov[`SUB_BIT] == (cyc >= 7 && cyc <= 9));
+  end
+endmodule
@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+set -e
+
+../../yosys -q -p "
+read_verilog taint_leak_monitor.v
+hierarchy -top taint_leak_top; proc
+cellift -exclude-signals clk
+taint_leak_monitor -assert -clk clk -cycle-width 8 taint_leak_sub/w:q
+select -assert-count 1 taint_leak_sub/o:taint_leak
+select -assert-count 1 taint_leak_top/o:taint_leak
+select -assert-count 0 taint_leak_sub/o:taint_leak_cycle
+select -assert-count 1 taint_leak_top/o:taint_leak_cycle
+select -assert-count 0 taint_leak_sub/t:\$assert
+select -assert-count 1 taint_leak_top/t:\$assert
+write_rtlil taint_leak_monitor.il
+"
+
+# The assertion of the toplevel fails in the cycle of the leak, which sim checks
+# at both of its clock phases
+../../yosys -q -p "
+read_rtlil taint_leak_monitor.il
+read_verilog -formal taint_leak_monitor_tb.v
+hierarchy -top taint_leak_monitor_tb; proc; chformal -lower
+logger -expect warning \"Assertion taint_leak_monitor_tb\\.dut\\..* failed\" 2
+logger -expect-no-warnings
+sim -clock clk -zinit -n 12
+"
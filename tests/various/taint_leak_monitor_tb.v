@@ -0,0 +1,17 @@
+module taint_leak_monitor_tb(input clk);
+  reg [3:0] cyc = 0;
+  always @(posedge clk) cyc <= cyc + 1;
+
+  wire [1:0] q, q_t0;
+  wire r, r_t0, taint_leak;
+  wire [7:0] taint_leak_cycle;
+  taint_leak_top dut(.clk(clk), .a(2'b00), .a_t0(cyc == 4 ? 2'b10 : 2'b00), .b(1'b0), .b_t0(cyc == 2),
+      .q(q), .q_t0(q_t0), .r(r), .r_t0(r_t0), .taint_leak(taint_leak), .taint_leak_cycle(taint_leak_cycle));
+
+  // Only u.q is a sink: the taint of b reaches r_t0 at cycle 3 without leaking, and
+  // that of a reaches u.q at cycle 5, which is latched as the cycle of the first leak.
+  always @* begin
+    assert(taint_leak == (cyc == 5));
+    assert(taint_leak_cycle == (cyc >= 6 ? 5 : 0));
+  end
+endmodule